@@ -0,0 +1,76 @@
+#ifndef LEARNOPENGL_BENCH_COMMON_H
+#define LEARNOPENGL_BENCH_COMMON_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include "renderer/stream_buffer.h"
+#include "structs/vertex_layout.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Shared setup for the benchmark executables. They are run from the build
+// directory like LearnOpenGL itself, so asset paths start with "../".
+
+// hidden window + GL 3.3 core context, vsync off so swaps don't hide CPU cost
+inline GLFWwindow* createBenchContext(int width = 800, int height = 600) {
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(width, height, "LearnOpenGL benchmark", nullptr, nullptr);
+    if (window == nullptr) {
+        std::cout << "Failed to create GLFW window, exiting..." << std::endl;
+        glfwTerminate();
+        exit(EXIT_FAILURE);
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
+        std::cout << "Failed to load GLAD, exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    loadBufferStorageExtension(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
+    glfwSwapInterval(0);
+    glViewport(0, 0, width, height);
+    std::cout << "GL: " << glGetString(GL_RENDERER) << " / " << glGetString(GL_VERSION) << std::endl;
+    return window;
+}
+
+// the same textured unit quad main.cpp draws, returns the VAO (VBO/EBO stay bound to it)
+inline unsigned int createBenchQuad() {
+    const float vertices[] = {
+        // positions          // colors           // texture coords
+        0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,
+        0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
+       -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,
+       -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f
+    };
+    const unsigned int indices[] = {0, 1, 3, 1, 2, 3};
+    unsigned int VAO, VBO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+    glGenBuffers(1, &VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glGenBuffers(1, &EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    VertexLayout::positionColorTexCoord().apply();
+    glBindVertexArray(0);
+    return VAO;
+}
+
+class BenchTimer {
+private:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+public:
+    void reset() {
+        start = std::chrono::steady_clock::now();
+    }
+    [[nodiscard]] double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+#endif //LEARNOPENGL_BENCH_COMMON_H
@@ -0,0 +1,145 @@
+// Load time of a large .lmesh scene: read into memory and upload vs memory map and upload from the mapping.
+// usage: bench_mesh_loading [megabytes] [scene file]
+// Without a scene file, one of about <megabytes> (default 256) MB of grid meshes is generated in the temp directory.
+#include <glad/glad.h>
+#include "benchmarks/bench_common.h"
+#include "structs/vertex_layout.h"
+#include "resources/mesh_file.h"
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// 256x256 vertex grids with a little height noise, the largest that still fit 16 bit indices
+MeshData makeGrid(unsigned int index) {
+    constexpr int SIDE = 256;
+    MeshData mesh;
+    mesh.name = "grid" + std::to_string(index);
+    mesh.layout = VertexLayout::quantized();
+    mesh.vertices.resize(SIDE * SIDE * sizeof(QuantizedVertex));
+    auto* vertices = reinterpret_cast<QuantizedVertex*>(mesh.vertices.data());
+    for (int y = 0; y < SIDE; y++) {
+        for (int x = 0; x < SIDE; x++) {
+            QuantizedVertex &vertex = vertices[y * SIDE + x];
+            const float u = static_cast<float>(x) / (SIDE - 1);
+            const float v = static_cast<float>(y) / (SIDE - 1);
+            vertex.position[0] = u - 0.5f;
+            vertex.position[1] = v - 0.5f;
+            vertex.position[2] = 0.01f * std::sin(static_cast<float>(index) + u * 20.0f) * std::cos(v * 20.0f);
+            vertex.color[0] = static_cast<uint8_t>(u * 255.0f);
+            vertex.color[1] = static_cast<uint8_t>(v * 255.0f);
+            vertex.color[2] = static_cast<uint8_t>(index * 31);
+            vertex.color[3] = 255;
+            vertex.texCoord[0] = floatToHalf(u);
+            vertex.texCoord[1] = floatToHalf(v);
+        }
+    }
+    for (uint32_t y = 0; y + 1 < SIDE; y++) {
+        for (uint32_t x = 0; x + 1 < SIDE; x++) {
+            const uint32_t corner = y * SIDE + x;
+            mesh.indices.insert(mesh.indices.end(), {corner, corner + 1, corner + SIDE, corner + 1, corner + SIDE + 1, corner + SIDE});
+        }
+    }
+    mesh.boundsMin[0] = mesh.boundsMin[1] = -0.5f;
+    mesh.boundsMax[0] = mesh.boundsMax[1] = 0.5f;
+    mesh.boundsMin[2] = -0.01f;
+    mesh.boundsMax[2] = 0.01f;
+    return mesh;
+}
+
+bool generateScene(const std::string &path, size_t megabytes) {
+    const MeshData sample = makeGrid(0);
+    const size_t meshBytes = sample.vertices.size() + sample.indices.size() * sizeof(uint16_t);
+    const size_t count = std::max<size_t>(1, megabytes * 1024 * 1024 / meshBytes);
+    std::vector<MeshData> meshes;
+    meshes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        meshes.push_back(makeGrid(static_cast<unsigned int>(i)));
+    }
+    return writeMeshFile(path, meshes);
+}
+
+struct LoadResult {
+    double openMs = 0.0;   // reading or mapping the file and parsing the entry table
+    double uploadMs = 0.0; // buffer uploads and VAO setup, until the GPU is done
+    size_t meshes = 0;
+    size_t bytes = 0;
+};
+
+LoadResult uploadAll(MeshFile &file, double openMs) {
+    LoadResult result;
+    result.openMs = openMs;
+    BenchTimer timer;
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    for (size_t i = 0; i < file.getMeshCount(); i++) {
+        std::shared_ptr<Mesh> mesh = file.upload(i);
+        if (!mesh) {
+            continue;
+        }
+        result.bytes += mesh->bytes;
+        meshes.push_back(std::move(mesh));
+    }
+    glFinish();
+    result.uploadMs = timer.elapsedMs();
+    result.meshes = meshes.size();
+    return result;
+}
+
+void report(const char* name, const LoadResult &result) {
+    const double totalMs = result.openMs + result.uploadMs;
+    std::cout << name << ": " << result.meshes << " meshes, " << result.bytes / (1024 * 1024) << " MB, open "
+              << result.openMs << " ms, upload " << result.uploadMs << " ms, total " << totalMs << " ms, "
+              << static_cast<double>(result.bytes) / (1024.0 * 1024.0) / (totalMs / 1000.0) << " MB/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    createBenchContext();
+    const size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    std::string path;
+    if (argc > 2) {
+        path = argv[2];
+    } else {
+        path = (fs::temp_directory_path() / ("learnopengl_scene_" + std::to_string(megabytes) + "mb.lmesh")).string();
+        if (!fs::exists(path)) {
+            std::cout << "Generating " << path << std::endl;
+            if (!generateScene(path, megabytes)) {
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    std::cout << "Loading " << path << ", " << fs::file_size(path) / (1024 * 1024) << " MB" << std::endl;
+
+    // both run against a warm page cache, the difference is the extra copy and allocation of the read path
+    for (int run = 0; run < 2; run++) {
+        {
+            BenchTimer timer;
+            std::ifstream stream(path, std::ios::binary | std::ios::ate);
+            std::vector<unsigned char> data(static_cast<size_t>(stream.tellg()));
+            stream.seekg(0);
+            stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            MeshFile file;
+            if (!file.openMemory(data.data(), data.size())) {
+                return EXIT_FAILURE;
+            }
+            report("read + upload", uploadAll(file, timer.elapsedMs()));
+        }
+        {
+            BenchTimer timer;
+            MeshFile file;
+            if (!file.open(path)) {
+                return EXIT_FAILURE;
+            }
+            report("mmap + upload", uploadAll(file, timer.elapsedMs()));
+        }
+    }
+
+    glfwTerminate();
+    return 0;
+}
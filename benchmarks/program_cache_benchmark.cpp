@@ -0,0 +1,86 @@
+// Cold vs warm startup cost of building many programs through ProgramCache.
+// usage: bench_program_cache [program count]
+// Mesa only exposes program binaries while its own shader cache is enabled, which also makes
+// repeated "no cache" runs faster than a truly cold start.
+#include <glad/glad.h>
+#include "benchmarks/bench_common.h"
+#include "shaders.h"
+#include "resources/program_cache.h"
+#include <GLFW/glfw3.h>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// every variant is a distinct program as far as any cache is concerned
+std::pair<std::string, std::string> makeVariant(const std::string &vertexCode, const std::string &fragmentCode,
+                                                unsigned int variant) {
+    const std::string define = "#define VARIANT " + std::to_string(variant) + "\n";
+    std::string vertex = vertexCode;
+    vertex.insert(vertex.find('\n') + 1, define);
+    std::string fragment = fragmentCode;
+    fragment.insert(fragment.find('\n') + 1, define);
+    fragment.insert(fragment.rfind('}'), "    FragColor.rgb *= 1.0 + float(VARIANT) * 0.0001;\n");
+    return {vertex, fragment};
+}
+
+// builds every variant and returns the elapsed milliseconds, including the GPU finishing up
+template<typename Build>
+double buildAll(const std::vector<std::pair<std::string, std::string>> &variants, Build build) {
+    BenchTimer timer;
+    std::vector<unsigned int> programs;
+    for (const auto &variant : variants) {
+        programs.push_back(build(variant.first, variant.second).getId());
+    }
+    glFinish();
+    const double ms = timer.elapsedMs();
+    for (unsigned int program : programs) {
+        glDeleteProgram(program);
+    }
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    createBenchContext();
+    const unsigned int count = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 48;
+
+    const std::string vertexCode = Shader::readFile("../shaders/vertex_shader.vs");
+    const std::string fragmentCode = Shader::readFile("../shaders/fragment_shader.fs");
+    std::vector<std::pair<std::string, std::string>> variants;
+    for (unsigned int i = 0; i < count; i++) {
+        variants.push_back(makeVariant(vertexCode, fragmentCode, i));
+    }
+
+    const fs::path directory = fs::temp_directory_path() / "learnopengl_program_cache_bench";
+    fs::remove_all(directory);
+
+    const double uncachedMs = buildAll(variants, [](const std::string &vertex, const std::string &fragment) {
+        return Shader::fromSource(vertex, fragment);
+    });
+
+    ProgramCache cold(directory);
+    if (!cold.isSupported()) {
+        std::cout << "no cache: " << uncachedMs << " ms for " << count << " programs" << std::endl;
+        return 1;
+    }
+    const double coldMs = buildAll(variants, [&cold](const std::string &vertex, const std::string &fragment) {
+        return cold.getShader(vertex, fragment);
+    });
+
+    // a fresh instance, as if the app had been restarted
+    ProgramCache warm(directory);
+    const double warmMs = buildAll(variants, [&warm](const std::string &vertex, const std::string &fragment) {
+        return warm.getShader(vertex, fragment);
+    });
+
+    std::cout << count << " programs" << std::endl;
+    std::cout << "no cache:   " << uncachedMs << " ms" << std::endl;
+    std::cout << "cold cache: " << coldMs << " ms, " << cold.getStats() << std::endl;
+    std::cout << "warm cache: " << warmMs << " ms, " << warm.getStats() << std::endl;
+
+    fs::remove_all(directory);
+    glfwTerminate();
+    return 0;
+}
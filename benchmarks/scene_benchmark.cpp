@@ -0,0 +1,147 @@
+// Updates and draws a large number of moving quads through SceneStore and
+// reports the cost per entity of each stage.
+// usage: bench_scene [entities] [frames]
+#include <glad/glad.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include "external/stb_image/stb_image.h"
+#include "benchmarks/bench_common.h"
+#include "shaders.h"
+#include "structs/shapes.h"
+#include "scene/scene_store.h"
+#include "renderer/batch_renderer.h"
+#include "resources/texture_loader.h"
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// the same update on one struct per object, for comparison
+struct ObjectAoS {
+    float position[3];
+    float velocity[2];
+    float scale;
+    float color[4];
+    unsigned int material;
+    unsigned int texture;
+};
+
+void updateAoS(std::vector<ObjectAoS> &objects, float deltaTime, const SceneBounds &bounds) {
+    for (ObjectAoS &object : objects) {
+        float x = object.position[0] + object.velocity[0] * deltaTime;
+        float y = object.position[1] + object.velocity[1] * deltaTime;
+        if (x > bounds.maxX || x < bounds.minX) {
+            x = x > bounds.maxX ? 2.0f * bounds.maxX - x : 2.0f * bounds.minX - x;
+            object.velocity[0] = -object.velocity[0];
+        }
+        if (y > bounds.maxY || y < bounds.minY) {
+            y = y > bounds.maxY ? 2.0f * bounds.maxY - y : 2.0f * bounds.minY - y;
+            object.velocity[1] = -object.velocity[1];
+        }
+        object.position[0] = x;
+        object.position[1] = y;
+    }
+}
+
+EntityDesc makeEntity(unsigned int i, uint32_t material, uint32_t texture) {
+    EntityDesc desc;
+    const float angle = static_cast<float>(i) * 2.39996f;
+    desc.position[0] = std::sin(static_cast<float>(i) * 12.9898f);
+    desc.position[1] = std::cos(static_cast<float>(i) * 78.233f);
+    desc.velocity[0] = std::cos(angle) * 0.5f;
+    desc.velocity[1] = std::sin(angle) * 0.5f;
+    desc.scale = 0.004f;
+    desc.color[0] = static_cast<float>(i % 255) / 255.0f;
+    desc.material = material;
+    desc.texture = texture;
+    return desc;
+}
+
+void report(const char* name, double ms, unsigned int frames, size_t entities) {
+    std::cout << name << ": " << ms / frames << " ms/frame, "
+              << ms * 1e6 / (static_cast<double>(frames) * static_cast<double>(entities)) << " ns/entity" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createBenchContext();
+    const auto count = static_cast<unsigned int>(argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000);
+    const unsigned int frames = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 60;
+    const float deltaTime = 1.0f / 60.0f;
+    const SceneBounds bounds;
+
+    {
+        // the placeholder is enough to draw with, no need to wait for a real image
+        TextureLoader textureLoader;
+        auto shader = std::make_shared<Shader>("../shaders/vertex_shader.vs", "../shaders/fragment_shader.fs");
+        auto mesh = std::make_shared<Mesh>();
+        mesh->VAO = createBenchQuad();
+        mesh->indexCount = 6;
+
+        SceneStore scene;
+        const uint32_t material = scene.addMaterial(shader, mesh);
+        const uint32_t texture = scene.addTexture(TextureHandle({}, textureLoader.getPlaceholder()));
+        scene.reserve(count);
+        std::vector<EntityHandle> handles;
+        handles.reserve(count);
+
+        BenchTimer createTimer;
+        for (unsigned int i = 0; i < count; i++) {
+            handles.push_back(scene.create(makeEntity(i, material, texture)));
+        }
+        std::cout << count << " entities created in " << createTimer.elapsedMs() << " ms" << std::endl;
+
+        // churn: swap-remove every 10th entity and create it again, handles of the others must survive
+        BenchTimer churnTimer;
+        for (size_t i = 0; i < handles.size(); i += 10) {
+            scene.destroy(handles[i]);
+        }
+        for (size_t i = 0; i < handles.size(); i += 10) {
+            handles[i] = scene.create(makeEntity(static_cast<unsigned int>(i), material, texture));
+        }
+        std::cout << "destroyed and recreated " << (handles.size() + 9) / 10 << " entities in "
+                  << churnTimer.elapsedMs() << " ms, " << scene.size() << " alive" << std::endl;
+
+        BatchRenderer batch;
+        double updateMs = 0.0;
+        double submitMs = 0.0;
+        double flushMs = 0.0;
+        BenchTimer total;
+        for (unsigned int frame = 0; frame < frames; frame++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            BenchTimer timer;
+            scene.update(deltaTime, bounds);
+            updateMs += timer.elapsedMs();
+            timer.reset();
+            scene.submit(batch);
+            submitMs += timer.elapsedMs();
+            timer.reset();
+            batch.flush();
+            flushMs += timer.elapsedMs();
+            glfwSwapBuffers(window);
+        }
+        glFinish();
+        const double totalMs = total.elapsedMs();
+
+        report("update (SoA)", updateMs, frames, count);
+        report("submit", submitMs, frames, count);
+        report("flush", flushMs, frames, count);
+        report("frame incl. GPU", totalMs, frames, count);
+
+        std::vector<ObjectAoS> objects;
+        objects.reserve(count);
+        for (unsigned int i = 0; i < count; i++) {
+            const EntityDesc desc = makeEntity(i, material, texture);
+            objects.push_back(ObjectAoS{{desc.position[0], desc.position[1], desc.position[2]},
+                                        {desc.velocity[0], desc.velocity[1]}, desc.scale,
+                                        {desc.color[0], desc.color[1], desc.color[2], desc.color[3]},
+                                        desc.material, desc.texture});
+        }
+        BenchTimer aosTimer;
+        for (unsigned int frame = 0; frame < frames; frame++) {
+            updateAoS(objects, deltaTime, bounds);
+        }
+        report("update (AoS)", aosTimer.elapsedMs(), frames, count);
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,120 @@
+// GL calls and submission cost of a scene that keeps switching programs, textures and VAOs:
+// every bind issued vs. the GLStateCache alone vs. the cache with the sorted RenderQueue.
+// usage: bench_state_sorting [quads] [textures] [frames]
+// Quads are submitted interleaved, the worst case for binds, once unbatched (a draw per quad)
+// and once batched (a draw per program + texture + VAO).
+#include <glad/glad.h>
+#include "benchmarks/bench_common.h"
+#include "shaders.h"
+#include "renderer/batch_renderer.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+struct SortingScene {
+    std::vector<unsigned int> programs;
+    std::vector<unsigned int> textures;
+    std::vector<unsigned int> VAOs;
+    unsigned int quads = 0;
+};
+
+// 4x4 single color textures, the content doesn't matter, only the binds do
+std::vector<unsigned int> createTextures(unsigned int count) {
+    std::vector<unsigned int> textures(count);
+    glGenTextures(static_cast<GLsizei>(count), textures.data());
+    for (unsigned int i = 0; i < count; i++) {
+        unsigned char pixels[4 * 4 * 4];
+        for (unsigned int p = 0; p < 16; p++) {
+            pixels[p * 4] = static_cast<unsigned char>(i * 53);
+            pixels[p * 4 + 1] = static_cast<unsigned char>(i * 97);
+            pixels[p * 4 + 2] = static_cast<unsigned char>(i * 151);
+            pixels[p * 4 + 3] = 255;
+        }
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    return textures;
+}
+
+// neighbouring quads never share a program, texture or VAO
+void submitScene(BatchRenderer &batch, const SortingScene &scene) {
+    const auto side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(scene.quads))));
+    const float cell = 2.0f / static_cast<float>(side);
+    for (unsigned int i = 0; i < scene.quads; i++) {
+        const float depth = std::sin(static_cast<float>(i) * 12.9898f);
+        const QuadInstance instance{{-1.0f + cell * (static_cast<float>(i % side) + 0.5f),
+                                     -1.0f + cell * (static_cast<float>(i / side) + 0.5f), depth},
+                                    cell * 0.9f, {1.0f, 1.0f, 1.0f, 1.0f}};
+        batch.submit(scene.programs[i % scene.programs.size()], scene.textures[(i * 7) % scene.textures.size()],
+                     scene.VAOs[(i / 3) % scene.VAOs.size()], 6, GL_UNSIGNED_INT, instance);
+    }
+}
+
+void run(GLFWwindow* window, const char* name, const SortingScene &scene, bool batched, bool stateCache, bool sorting,
+         unsigned int frames) {
+    BatchRenderer batch;
+    batch.setBatching(batched);
+    batch.setStateCache(stateCache);
+    batch.setSorting(sorting);
+    // one frame to grow the stream buffer and the queue
+    submitScene(batch, scene);
+    batch.flush();
+    glFinish();
+
+    double submitMs = 0.0;
+    double sortMs = 0.0;
+    BenchTimer timer;
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT);
+        submitScene(batch, scene);
+        batch.flush();
+        submitMs += batch.getStats().submitMs;
+        sortMs += batch.getStats().sortMs;
+        glfwSwapBuffers(window);
+        glFinish();
+    }
+    const double frameMs = timer.elapsedMs() / frames;
+    const BatchStats &stats = batch.getStats();
+    std::cout << name << ": " << stats.drawCalls << " draws, binds (program/texture/vao) " << stats.programBinds << "/"
+              << stats.textureBinds << "/" << stats.vaoBinds << ", " << stats.calls << " and " << stats.attributeSetups
+              << " attribute setups per frame, sort "
+              << stats.sortPasses << " passes " << sortMs / frames << " ms, flush " << submitMs / frames
+              << " ms, frame " << frameMs << " ms" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createBenchContext();
+    SortingScene scene;
+    scene.quads = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 20000;
+    const unsigned int textureCount = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 64;
+    const unsigned int frames = argc > 3 ? static_cast<unsigned int>(std::strtoul(argv[3], nullptr, 10)) : 30;
+    std::cout << scene.quads << " quads, 2 programs, " << textureCount << " textures, 2 VAOs" << std::endl;
+
+    {
+        // the same program twice still counts as two programs to bind
+        const Shader first("../shaders/vertex_shader.vs", "../shaders/fragment_shader.fs");
+        const Shader second("../shaders/vertex_shader.vs", "../shaders/fragment_shader.fs");
+        scene.programs = {first.getId(), second.getId()};
+        scene.textures = createTextures(std::max(1u, textureCount));
+        scene.VAOs = {createBenchQuad(), createBenchQuad()};
+
+        for (const bool batched : {false, true}) {
+            std::cout << (batched ? "batched" : "unbatched") << std::endl;
+            run(window, "  every bind", scene, batched, false, false, frames);
+            run(window, "  state cache", scene, batched, true, false, frames);
+            run(window, "  state cache + sort", scene, batched, true, true, frames);
+        }
+
+        glDeleteTextures(static_cast<GLsizei>(scene.textures.size()), scene.textures.data());
+        glDeleteVertexArrays(static_cast<GLsizei>(scene.VAOs.size()), scene.VAOs.data());
+        glDeleteProgram(first.getId());
+        glDeleteProgram(second.getId());
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,133 @@
+// Separate textures vs one block compressed TextureAtlas: GPU memory, binds, draw calls and frame time.
+// usage: bench_texture_atlas [image count] [frames]
+// Images of mixed sizes between 32x32 and 256x256 are generated in the temp directory.
+#include <glad/glad.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include "external/stb_image/stb_image.h"
+#include "benchmarks/bench_common.h"
+#include "shaders.h"
+#include "renderer/batch_renderer.h"
+#include "resources/texture_atlas.h"
+#include "resources/texture_loader.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// smooth stripes and a checker, closer to real textures than noise, which no block format handles well
+std::vector<std::string> generateImages(const fs::path &directory, unsigned int count) {
+    fs::create_directories(directory);
+    std::vector<std::string> paths;
+    for (unsigned int i = 0; i < count; i++) {
+        const int width = 32 << (i % 4);
+        const int height = 32 << ((i / 4) % 4);
+        const fs::path path = directory / ("atlas_" + std::to_string(i) + ".ppm");
+        paths.push_back(path.string());
+        if (fs::exists(path)) {
+            continue;
+        }
+        std::vector<unsigned char> pixels(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
+        const float frequency = 0.05f + 0.01f * static_cast<float>(i % 13);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                unsigned char* p = &pixels[(static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x)) * 3];
+                p[0] = static_cast<unsigned char>(127.0f + 127.0f * std::sin(static_cast<float>(x) * frequency));
+                p[1] = static_cast<unsigned char>(127.0f + 127.0f * std::cos(static_cast<float>(y) * frequency));
+                p[2] = static_cast<unsigned char>((i * 37 + ((x / 8 + y / 8) % 2) * 100) % 256);
+            }
+        }
+        std::ofstream file(path, std::ios::binary);
+        file << "P6\n" << width << " " << height << "\n255\n";
+        file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    }
+    return paths;
+}
+
+// one quad per image, textures[i] and rects[i] belong to image i
+double renderFrames(GLFWwindow* window, BatchRenderer &batch, const Shader &shader, unsigned int VAO,
+                    const std::vector<unsigned int> &textures, const std::vector<TextureRect> &rects, unsigned int frames) {
+    const auto side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(std::max<size_t>(1, textures.size())))));
+    const float cell = 2.0f / static_cast<float>(side);
+    BenchTimer timer;
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (size_t i = 0; i < textures.size(); i++) {
+            QuadInstance instance{{-1.0f + cell * (static_cast<float>(i % side) + 0.5f),
+                                   -1.0f + cell * (static_cast<float>(i / side) + 0.5f), 0.0f},
+                                  cell, {1.0f, 1.0f, 1.0f, 1.0f}};
+            instance.texRect[0] = rects[i].u;
+            instance.texRect[1] = rects[i].v;
+            instance.texRect[2] = rects[i].width;
+            instance.texRect[3] = rects[i].height;
+            batch.submit(shader.getId(), textures[i], VAO, 6, GL_UNSIGNED_INT, instance);
+        }
+        batch.flush();
+        glfwSwapBuffers(window);
+        glFinish(); // count the frame as presented only once the GPU is done with it
+    }
+    return timer.elapsedMs() / frames;
+}
+
+void printResult(const char* name, size_t bytes, const BatchStats &stats, double frameMs) {
+    std::cout << name << ": " << bytes << " B, " << stats.textureBinds << " texture binds, " << stats.drawCalls
+              << " draw calls, " << frameMs << " ms/frame" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createBenchContext();
+    const unsigned int count = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 256;
+    const unsigned int frames = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 100;
+    const fs::path directory = fs::temp_directory_path() / "learnopengl_atlas_bench";
+    std::cout << "Generating " << count << " images in " << directory << std::endl;
+    const std::vector<std::string> paths = generateImages(directory / "images", count);
+
+    const Shader shader("../shaders/vertex_shader.vs", "../shaders/fragment_shader.fs");
+    const unsigned int VAO = createBenchQuad();
+    BatchRenderer batch;
+
+    // 1. a texture per image, the way TextureLoader uploads them
+    std::vector<unsigned int> textures;
+    size_t separateBytes = 0;
+    for (const std::string &path : paths) {
+        textures.push_back(loadTextureSync(path.c_str()));
+        int width = 0;
+        int height = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+        const auto bytes = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+        separateBytes += bytes + bytes / 3;
+    }
+    const std::vector<TextureRect> wholeTextures(paths.size());
+    const double separateMs = renderFrames(window, batch, shader, VAO, textures, wholeTextures, frames);
+    printResult("separate RGBA8", separateBytes, batch.getStats(), separateMs);
+    glDeleteTextures(static_cast<GLsizei>(textures.size()), textures.data());
+
+    // 2. the atlas, once built from scratch and once restored from its cache entry
+    const fs::path cacheDirectory = directory / "cache";
+    fs::remove_all(cacheDirectory);
+    {
+        const TextureAtlas cold(paths, cacheDirectory);
+        std::cout << cold.getStats() << std::endl;
+    }
+    {
+        const TextureAtlas atlas(paths, cacheDirectory);
+        std::cout << atlas.getStats() << std::endl;
+        std::vector<unsigned int> atlasTextures(paths.size(), atlas.getTexture().id());
+        std::vector<TextureRect> rects;
+        for (const std::string &path : paths) {
+            rects.push_back(atlas.getRect(static_cast<size_t>(atlas.find(path))));
+        }
+        const double atlasMs = renderFrames(window, batch, shader, VAO, atlasTextures, rects, frames);
+        printResult("atlas", atlas.getStats().bytes, batch.getStats(), atlasMs);
+    } // the atlas owns its texture, delete it while the context is still there
+
+    glfwTerminate();
+    return 0;
+}
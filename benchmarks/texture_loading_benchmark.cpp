@@ -0,0 +1,155 @@
+// Compares the old synchronous texture path against TextureLoader, once with workers
+// copying into mapped staging PBOs and once uploading from client memory on the GL thread.
+// usage: bench_texture_loading [image directory] [image count]
+// Without a directory, <image count> (default 400) noisy 512x512 images are generated in the temp directory.
+#include <glad/glad.h>
+#define STB_IMAGE_IMPLEMENTATION
+#include "external/stb_image/stb_image.h"
+#include "benchmarks/bench_common.h"
+#include "shaders.h"
+#include "renderer/batch_renderer.h"
+#include "resources/texture_loader.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+std::vector<std::string> generateImages(const fs::path &directory, unsigned int count) {
+    const int size = 512;
+    fs::create_directories(directory);
+    std::vector<std::string> paths;
+    std::vector<unsigned char> pixels(size * size * 3);
+    uint32_t seed = 12345;
+    for (unsigned int i = 0; i < count; i++) {
+        const fs::path path = directory / ("image_" + std::to_string(i) + ".ppm");
+        paths.push_back(path.string());
+        if (fs::exists(path)) {
+            continue;
+        }
+        for (unsigned char &p : pixels) {
+            seed = seed * 1664525u + 1013904223u;
+            p = static_cast<unsigned char>(seed >> 24);
+        }
+        std::ofstream file(path, std::ios::binary);
+        file << "P6\n" << size << " " << size << "\n255\n";
+        file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+    }
+    return paths;
+}
+
+std::vector<std::string> listImages(const fs::path &directory) {
+    std::vector<std::string> paths;
+    for (const auto &entry : fs::directory_iterator(directory)) {
+        if (entry.is_regular_file()) {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+// draw one small quad per texture so every texture is actually sampled
+void renderFrame(GLFWwindow* window, BatchRenderer &batch, const Shader &shader, unsigned int VAO,
+                 const std::vector<unsigned int> &textures) {
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    shader.use();
+    const auto side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(std::max<size_t>(1, textures.size())))));
+    const float cell = 2.0f / static_cast<float>(side);
+    for (size_t i = 0; i < textures.size(); i++) {
+        const float x = -1.0f + cell * (static_cast<float>(i % side) + 0.5f);
+        const float y = -1.0f + cell * (static_cast<float>(i / side) + 0.5f);
+        batch.submit(shader.getId(), textures[i], VAO, 6, GL_UNSIGNED_INT,
+                     QuadInstance{{x, y, 0.0f}, cell, {1.0f, 1.0f, 1.0f, 1.0f}});
+    }
+    batch.flush();
+    glfwSwapBuffers(window);
+    glFinish(); // count the frame as presented only once the GPU is done with it
+}
+
+// first frame goes out with placeholders, textures stream in afterwards
+void runAsync(GLFWwindow* window, const char* name, BatchRenderer &batch, const Shader &shader, unsigned int VAO,
+              const std::vector<std::string> &paths, unsigned int stagingBuffers) {
+    double firstFrame = 0.0;
+    double total = 0.0;
+    unsigned int frames = 0;
+    TextureLoaderStats stats;
+    {
+        BenchTimer timer;
+        TextureLoader loader(std::max(2u, std::thread::hardware_concurrency()) - 1, 8 * 1024 * 1024, stagingBuffers);
+        std::vector<TextureHandle> handles;
+        handles.reserve(paths.size());
+        for (const std::string &path : paths) {
+            handles.push_back(loader.load(path));
+        }
+        std::vector<unsigned int> textures(handles.size());
+        bool done = false;
+        while (!done) {
+            done = loader.idle(); // check before update so the last uploads get drawn too
+            loader.update();
+            for (size_t i = 0; i < handles.size(); i++) {
+                textures[i] = handles[i].id();
+            }
+            renderFrame(window, batch, shader, VAO, textures);
+            if (frames++ == 0) {
+                firstFrame = timer.elapsedMs();
+            }
+        }
+        total = timer.elapsedMs();
+        stats = loader.getStats();
+    } // the handles own their textures and delete them here
+
+    std::cout << name << ": time to first frame " << firstFrame << " ms, total " << total << " ms over " << frames
+              << " frames" << std::endl;
+    std::cout << name << ": " << stats.uploaded << " uploaded (" << stats.stagedUploads << " staged, "
+              << stats.clientUploads << " from client memory), " << stats.failed << " failed, "
+              << stats.uploadedBytes / (1024 * 1024) << " MiB, decode " << stats.decodeMs
+              << " ms (all workers), GL thread " << stats.uploadMs << " ms (" << stats.uploadMs / frames
+              << " per frame), longest update " << stats.maxUpdateMs << " ms" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createBenchContext();
+
+    std::vector<std::string> paths;
+    if (argc > 1 && fs::is_directory(argv[1])) {
+        paths = listImages(argv[1]);
+    } else {
+        const unsigned int count = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 400;
+        const fs::path directory = fs::temp_directory_path() / "learnopengl_texture_bench";
+        std::cout << "Generating " << count << " images in " << directory << std::endl;
+        paths = generateImages(directory, count);
+    }
+    std::cout << "Loading " << paths.size() << " images" << std::endl;
+
+    const Shader shader("../shaders/vertex_shader.vs", "../shaders/fragment_shader.fs");
+    const unsigned int VAO = createBenchQuad();
+    BatchRenderer batch;
+
+    // 1. synchronous: nothing can be drawn until every texture is decoded and uploaded
+    BenchTimer timer;
+    std::vector<unsigned int> syncTextures;
+    for (const std::string &path : paths) {
+        syncTextures.push_back(loadTextureSync(path.c_str()));
+    }
+    renderFrame(window, batch, shader, VAO, syncTextures);
+    const double syncTotal = timer.elapsedMs();
+    glDeleteTextures(static_cast<GLsizei>(syncTextures.size()), syncTextures.data());
+
+    std::cout << "sync: time to first frame " << syncTotal << " ms, total " << syncTotal << " ms" << std::endl;
+
+    // 2. asynchronous, the GL thread only unmaps and issues the transfer
+    runAsync(window, "async staged", batch, shader, VAO, paths, 8);
+    // 3. asynchronous, the GL thread copies every image into the driver
+    runAsync(window, "async client", batch, shader, VAO, paths, 0);
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Scalar vs SIMD, single vs multi threaded update + cull of SceneStore entities.
+// CPU only, no GL context is created.
+// usage: bench_update [max threads] [frames] [entity counts...]
+#include <glad/glad.h>
+#include "benchmarks/bench_common.h"
+#include "scene/scene_store.h"
+#include "scene/thread_pool.h"
+#include "scene/update_kernels.h"
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// quads start spread a bit past the viewport so culling has something to do
+void fillScene(SceneStore &scene, size_t count) {
+    scene.reserve(count);
+    EntityDesc desc;
+    desc.scale = 0.01f;
+    for (size_t i = 0; i < count; i++) {
+        const auto f = static_cast<float>(i);
+        const float angle = f * 2.39996f;
+        desc.position[0] = 1.5f * std::sin(f * 12.9898f);
+        desc.position[1] = 1.5f * std::cos(f * 78.233f);
+        desc.velocity[0] = std::cos(angle) * 0.5f;
+        desc.velocity[1] = std::sin(angle) * 0.5f;
+        scene.create(desc);
+    }
+}
+
+struct RunResult {
+    double ms = 0.0;
+    size_t visible = 0;
+};
+
+RunResult run(size_t count, unsigned int frames, SimdLevel level, unsigned int threads) {
+    SceneStore scene;
+    fillScene(scene, count);
+    ThreadPool pool(threads);
+    const SceneBounds bounds{-1.5f, 1.5f, -1.5f, 1.5f};
+    const SceneBounds view;
+    RunResult result;
+    BenchTimer timer;
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        scene.updateAndCull(1.0f / 60.0f, bounds, view, pool, level);
+    }
+    result.ms = timer.elapsedMs() / frames;
+    result.visible = scene.getVisible().size();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const unsigned int maxThreads = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10))
+                                             : std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int frames = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 20;
+    std::vector<size_t> counts;
+    for (int i = 3; i < argc; i++) {
+        counts.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (counts.empty()) {
+        counts = {100000, 1000000, 10000000};
+    }
+
+    const SimdLevel best = detectSimdLevel();
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+    if (best != SimdLevel::Scalar) {
+        levels.push_back(SimdLevel::SSE);
+    }
+    if (best == SimdLevel::AVX) {
+        levels.push_back(SimdLevel::AVX);
+    }
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (const size_t count : counts) {
+        std::cout << count << " entities, " << frames << " frames" << std::endl;
+        // the plain loop from SceneStore::update(), no culling
+        {
+            SceneStore scene;
+            fillScene(scene, count);
+            const SceneBounds bounds{-1.5f, 1.5f, -1.5f, 1.5f};
+            BenchTimer timer;
+            for (unsigned int frame = 0; frame < frames; frame++) {
+                scene.update(1.0f / 60.0f, bounds);
+            }
+            const double ms = timer.elapsedMs() / frames;
+            std::cout << "  scalar update loop, 1 thread: " << ms << " ms, "
+                      << ms * 1e6 / static_cast<double>(count) << " ns/entity" << std::endl;
+        }
+
+        const RunResult baseline = run(count, frames, SimdLevel::Scalar, 1);
+        for (const SimdLevel level : levels) {
+            for (const unsigned int threads : threadCounts) {
+                const RunResult result = level == SimdLevel::Scalar && threads == 1
+                        ? baseline : run(count, frames, level, threads);
+                std::cout << "  " << simdLevelName(level) << " update + cull, " << threads << " threads: "
+                          << result.ms << " ms, " << result.ms * 1e6 / static_cast<double>(count) << " ns/entity, "
+                          << baseline.ms / result.ms << "x, " << result.visible << " visible";
+                if (result.visible != baseline.visible) {
+                    std::cout << " (MISMATCH, scalar saw " << baseline.visible << ")";
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Streams CPU generated triangles every frame, once through a single VBO updated
+// with glBufferSubData and once through StreamBuffer.
+// usage: bench_vertex_streaming [vertices per frame] [frames]
+#include <glad/glad.h>
+#include "benchmarks/bench_common.h"
+#include "shaders.h"
+#include "renderer/stream_buffer.h"
+#include <GLFW/glfw3.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct StreamVertex {
+    float position[3];
+    uint32_t color; // RGBA8, normalized in the shader input
+};
+
+inline auto streamVertexShaderSource =
+        "#version 330 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in vec4 aColor;\n"
+        "out vec4 color;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = vec4(aPos, 1.0);\n"
+        "    color = aColor;\n"
+        "}\0";
+
+inline auto streamFragmentShaderSource =
+        "#version 330 core\n"
+        "in vec4 color;\n"
+        "out vec4 FragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    FragColor = color;\n"
+        "}\0";
+
+// tiny triangles scattered over the screen, moving a bit every frame like particles
+void generateVertices(StreamVertex* out, size_t count, unsigned int frame) {
+    const float time = static_cast<float>(frame) * 0.01f;
+    for (size_t i = 0; i < count; i += 3) {
+        const auto particle = static_cast<float>(i / 3);
+        const float x = std::sin(particle * 12.9898f + time);
+        const float y = std::cos(particle * 78.233f + time);
+        const auto color = static_cast<uint32_t>(0xFF000000u | (static_cast<uint32_t>(i) * 2654435761u >> 8));
+        out[i] = StreamVertex{{x, y, 0.0f}, color};
+        if (i + 1 < count) out[i + 1] = StreamVertex{{x + 0.004f, y, 0.0f}, color};
+        if (i + 2 < count) out[i + 2] = StreamVertex{{x, y + 0.004f, 0.0f}, color};
+    }
+}
+
+void setVertexLayout(uintptr_t offset) {
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(StreamVertex),
+                          reinterpret_cast<void*>(offset + offsetof(StreamVertex, position)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(StreamVertex),
+                          reinterpret_cast<void*>(offset + offsetof(StreamVertex, color)));
+    glEnableVertexAttribArray(1);
+}
+
+void report(const char* name, size_t vertices, unsigned int frames, double ms) {
+    const double bytesPerFrame = static_cast<double>(vertices * sizeof(StreamVertex));
+    std::cout << name << ": " << ms / frames << " ms/frame, "
+              << bytesPerFrame / (1024.0 * 1024.0) << " MB/frame, "
+              << static_cast<double>(vertices) * frames / (ms / 1000.0) / 1e6 << " M vertices/s, "
+              << bytesPerFrame * frames / (ms / 1000.0) / (1024.0 * 1024.0) << " MB/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    GLFWwindow* window = createBenchContext();
+    size_t vertices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300000;
+    vertices -= vertices % 3;
+    const unsigned int frames = argc > 2 ? static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10)) : 200;
+    const size_t frameBytes = vertices * sizeof(StreamVertex);
+
+    const Shader shader = Shader::fromSource(streamVertexShaderSource, streamFragmentShaderSource);
+    shader.use();
+    unsigned int VAO;
+    glGenVertexArrays(1, &VAO);
+    glBindVertexArray(VAO);
+
+    // 1. one VBO, the CPU builds the frame in its own memory and glBufferSubData copies it over
+    {
+        unsigned int VBO;
+        glGenBuffers(1, &VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(frameBytes), nullptr, GL_DYNAMIC_DRAW);
+        setVertexLayout(0);
+        std::vector<StreamVertex> staging(vertices);
+
+        BenchTimer timer;
+        for (unsigned int frame = 0; frame < frames; frame++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            generateVertices(staging.data(), vertices, frame);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(frameBytes), staging.data());
+            glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices));
+            glfwSwapBuffers(window);
+        }
+        glFinish();
+        report("glBufferSubData", vertices, frames, timer.elapsedMs());
+        glDeleteBuffers(1, &VBO);
+    }
+
+    // 2. ring buffer, the CPU writes straight into GPU visible memory
+    {
+        StreamBuffer stream(GL_ARRAY_BUFFER, frameBytes);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.getBuffer());
+
+        BenchTimer timer;
+        for (unsigned int frame = 0; frame < frames; frame++) {
+            glClear(GL_COLOR_BUFFER_BIT);
+            stream.beginFrame();
+            size_t offset = 0;
+            auto* out = static_cast<StreamVertex*>(stream.map(frameBytes, offset, sizeof(StreamVertex)));
+            if (out != nullptr) {
+                generateVertices(out, vertices, frame);
+                stream.unmap();
+                glBindBuffer(GL_ARRAY_BUFFER, stream.getBuffer());
+                setVertexLayout(offset);
+                glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(vertices));
+            }
+            stream.endFrame();
+            glfwSwapBuffers(window);
+        }
+        glFinish();
+        report(stream.isPersistent() ? "StreamBuffer (persistent)" : "StreamBuffer (unsynchronized map)", vertices,
+               frames, timer.elapsedMs());
+        std::cout << "StreamBuffer: " << stream.getStats().stalls << " fence stalls, "
+                  << stream.getStats().waitMs << " ms waiting" << std::endl;
+    }
+
+    glDeleteVertexArrays(1, &VAO);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,126 @@
+#ifndef LEARNOPENGL_HEADLESS_CONTEXT_H
+#define LEARNOPENGL_HEADLESS_CONTEXT_H
+
+#include <glad/glad.h>
+#include "renderer/stream_buffer.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+// GL 3.3 core context without a window or display server, for CI and GPU-less render boxes.
+// Uses EGL_MESA_platform_surfaceless when available (Mesa, including llvmpipe), otherwise the
+// default EGL display. There is no default framebuffer, render into an OffscreenTarget instead.
+class HeadlessContext {
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+
+    static bool hasExtension(const char* extensions, const char* name) {
+        if (extensions == nullptr) {
+            return false;
+        }
+        const size_t length = std::strlen(name);
+        for (const char* found = std::strstr(extensions, name); found != nullptr; found = std::strstr(found + length, name)) {
+            const bool startsWord = found == extensions || found[-1] == ' ';
+            const bool endsWord = found[length] == ' ' || found[length] == '\0';
+            if (startsWord && endsWord) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void openDisplay() {
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+            auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                    eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay != nullptr) {
+                display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+        }
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+    }
+
+public:
+    HeadlessContext() = default;
+
+    ~HeadlessContext() {
+        destroy();
+    }
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // creates the context, makes it current and loads GLAD, returns false with a message on failure
+    bool create() {
+        openDisplay();
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+            std::cout << "Failed to initialize EGL" << std::endl;
+            display = EGL_NO_DISPLAY;
+            return false;
+        }
+        if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+            std::cout << "EGL display doesn't support surfaceless contexts" << std::endl;
+            destroy();
+            return false;
+        }
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            std::cout << "EGL display doesn't support desktop OpenGL" << std::endl;
+            destroy();
+            return false;
+        }
+
+        // surfaceless contexts don't need a config, but not every driver supports EGL_KHR_no_config_context
+        EGLConfig config = nullptr;
+        const EGLint configAttributes[] = {
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+        EGLint configCount = 0;
+        eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 3,
+            EGL_CONTEXT_MINOR_VERSION, 3,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, configCount > 0 ? config : nullptr, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT) {
+            std::cout << "Failed to create EGL context" << std::endl;
+            destroy();
+            return false;
+        }
+        if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+            std::cout << "Failed to make EGL context current" << std::endl;
+            destroy();
+            return false;
+        }
+        if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress))) {
+            std::cout << "Failed to load GLAD" << std::endl;
+            destroy();
+            return false;
+        }
+        loadBufferStorageExtension(reinterpret_cast<GLADloadproc>(eglGetProcAddress));
+        return true;
+    }
+
+    void destroy() {
+        if (display == EGL_NO_DISPLAY) {
+            return;
+        }
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context != EGL_NO_CONTEXT) {
+            eglDestroyContext(display, context);
+            context = EGL_NO_CONTEXT;
+        }
+        eglTerminate(display);
+        display = EGL_NO_DISPLAY;
+    }
+};
+
+#endif //LEARNOPENGL_HEADLESS_CONTEXT_H
@@ -0,0 +1,100 @@
+#ifndef LEARNOPENGL_IMAGE_COMPARE_H
+#define LEARNOPENGL_IMAGE_COMPARE_H
+
+#include "external/stb_image/stb_image.h"
+#include "renderer/frame_readback.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Writing captured frames and comparing them against golden images for the headless mode.
+// Images are binary PPMs: no extra dependency to write them, stb_image reads them back,
+// and most image viewers open them.
+
+// writes the RGB channels of an RGBA frame, alpha is dropped
+inline bool writePPM(const std::string &path, const CapturedFrame &frame) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        std::cout << "Failed to write image " << path << std::endl;
+        return false;
+    }
+    std::fprintf(file, "P6\n%d %d\n255\n", frame.width, frame.height);
+    std::vector<unsigned char> row(static_cast<size_t>(frame.width) * 3);
+    for (int y = 0; y < frame.height; y++) {
+        const unsigned char* source = frame.pixels.data() + static_cast<size_t>(y) * frame.width * 4;
+        for (int x = 0; x < frame.width; x++) {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        std::fwrite(row.data(), 1, row.size(), file);
+    }
+    const bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+// loads any image stb_image understands as RGBA, false if it's missing or unreadable
+inline bool readImage(const std::string &path, CapturedFrame &out) {
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (pixels == nullptr) {
+        return false;
+    }
+    out.width = width;
+    out.height = height;
+    out.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+struct ImageDiff {
+    bool sizeMatches = false;
+    size_t differingPixels = 0; // pixels with any RGB channel off by more than the tolerance
+    int maxDifference = 0;      // largest per channel difference, 0-255
+    double meanDifference = 0.0;
+    std::vector<unsigned char> mask; // RGBA, differing pixels in red over a dimmed copy of the golden
+};
+
+// Rasterization differs slightly between drivers, so a few channel values of slack is normal.
+// Alpha is ignored since the PPM goldens don't store it.
+inline ImageDiff compareImages(const CapturedFrame &actual, const CapturedFrame &golden, int tolerance = 2) {
+    ImageDiff diff;
+    diff.sizeMatches = actual.width == golden.width && actual.height == golden.height;
+    if (!diff.sizeMatches) {
+        return diff;
+    }
+    const size_t pixelCount = static_cast<size_t>(actual.width) * actual.height;
+    diff.mask.resize(pixelCount * 4);
+    double total = 0.0;
+    for (size_t i = 0; i < pixelCount; i++) {
+        const unsigned char* a = &actual.pixels[i * 4];
+        const unsigned char* g = &golden.pixels[i * 4];
+        int pixelMax = 0;
+        for (int c = 0; c < 3; c++) {
+            const int difference = std::abs(static_cast<int>(a[c]) - static_cast<int>(g[c]));
+            pixelMax = std::max(pixelMax, difference);
+            total += difference;
+        }
+        diff.maxDifference = std::max(diff.maxDifference, pixelMax);
+        unsigned char* m = &diff.mask[i * 4];
+        if (pixelMax > tolerance) {
+            diff.differingPixels++;
+            m[0] = 255;
+            m[1] = 0;
+            m[2] = 0;
+        } else {
+            m[0] = static_cast<unsigned char>(g[0] / 4);
+            m[1] = static_cast<unsigned char>(g[1] / 4);
+            m[2] = static_cast<unsigned char>(g[2] / 4);
+        }
+        m[3] = 255;
+    }
+    diff.meanDifference = total / static_cast<double>(pixelCount * 3);
+    return diff;
+}
+
+#endif //LEARNOPENGL_IMAGE_COMPARE_H
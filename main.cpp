@@ -3,41 +3,100 @@
 #include "external/stb_image/stb_image.h"
 #include "shaders.h"
 #include "structs/shapes.h"
+#include "renderer/batch_renderer.h"
+#include "resources/texture_loader.h"
+#include "resources/resource_cache.h"
+#include "resources/program_cache.h"
+#include "resources/shader_reloader.h"
+#include "resources/texture_atlas.h"
+#include "profiling/profiler.h"
+#include "scene/scene_store.h"
+#include "scene/simulation.h"
+#include "renderer/offscreen_target.h"
+#include "renderer/frame_readback.h"
+#include "headless/image_compare.h"
+#ifdef LEARNOPENGL_HEADLESS
+#include "headless/headless_context.h"
+constexpr bool HEADLESS_EGL = true;
+#else
+constexpr bool HEADLESS_EGL = false;
+#endif
+#include <string>
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <cstdlib>
+#include <chrono>
+#include <cctype>
 #include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// command line options, see the usage line in main()
+struct AppOptions {
+    unsigned int quadCount = 1;
+    bool batched = true;
+    bool atlas = false; // pack every texture into one compressed atlas instead of a texture each
+    bool hotReload = false; // rebuild shaders when their files change, always on with a window
+    std::string meshPath;   // .lmesh file to draw instead of the quad, see tools/obj_converter.cpp
+    std::string tracePath;
+    // headless mode: render a fixed number of frames into an FBO, capture and compare them
+    bool headless = false;
+    unsigned int frames = 300;
+    double fixedStep = 1.0 / 60.0;
+    // simulation thread
+    double tickRate = 60.0;
+    bool lockstep = false;  // tick once per frame on the render thread instead, always on when headless
+    double simLoadMs = 0.0;    // artificial work per tick
+    double renderLoadMs = 0.0; // artificial work per frame
+    int width = 800;
+    int height = 600;
+    unsigned int captureEvery = 0; // 0 only captures the last frame
+    std::string outputDir;
+    std::string goldenDir;
+    bool updateGolden = false;
+    int tolerance = 2;
+};
 
 // main application process functions
-GLFWwindow* createWindow();
+AppOptions parseOptions(int argc, char** argv);
+GLFWwindow* createWindow(bool visible, int width, int height);
 void processInput(GLFWwindow* window);
+bool checkCapture(const CapturedFrame &frame, const AppOptions &options);
 
 // shapes
-Triangle getDrawableTriangle(const float* vertices, size_t vertexSize);
-void drawTriangle(const Triangle &triangle);
-void updateTriangle(Triangle triangle);
+std::vector<std::string> listTextures(const std::string &directory);
+void addQuadGrid(SceneStore &scene, const float* vertices, size_t vertexSize, ResourceCache &resources,
+                 const std::string &meshPath, const TextureAtlas* atlas, const std::vector<std::string> &texturePaths,
+                 unsigned int count);
+void printBatchStats(const BatchStats &stats);
 
 bool MOVE_ENABLED = false;
 
-int main() {
-    // Initialize the glfw window library
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    // Run OpenGL with the Core profile
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Load the window
-    GLFWwindow* window = createWindow();
-    glfwMakeContextCurrent(window);
-
-    // Load GLAD
-    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
-        std::cout << "Failed to load GLAD, exiting..." << std::endl;
-        exit(EXIT_FAILURE);
+int main(int argc, char** argv) {
+    const auto startupBegin = std::chrono::steady_clock::now();
+    const AppOptions options = parseOptions(argc, argv);
+
+    GLFWwindow* window = nullptr;
+#ifdef LEARNOPENGL_HEADLESS
+    HeadlessContext headlessContext;
+    if (options.headless) {
+        // EGL surfaceless, works without a display server or GPU
+        if (!headlessContext.create()) {
+            exit(EXIT_FAILURE);
+        }
+    }
+#endif
+    if (!(options.headless && HEADLESS_EGL)) {
+        // Without EGL support the headless mode still renders offscreen, just through a hidden window
+        window = createWindow(!options.headless, options.width, options.height);
     }
 
-    glViewport(0, 0, 800, 600);
+    glViewport(0, 0, options.width, options.height);
 
     // Base of the F
     float vertices[] = {
@@ -50,38 +109,286 @@ int main() {
 
     // End bottom arm
 
-    const Triangle drawableTriangle1 = getDrawableTriangle(vertices, sizeof(vertices));
-
-    // Render loop
-    while(!glfwWindowShouldClose(window)) {
-        // Process input
-        processInput(window);
-        // Render commands
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+    bool goldensMatch = true;
+    {
+        // Decodes textures in the background, the quad shows a placeholder until wall.jpg is uploaded
+        TextureLoader textureLoader;
+        // Linked programs are kept on disk so the next launch can skip compiling them
+        ProgramCache programCache;
+        // Edited shader files are recompiled in the background and swapped in at the start of a frame.
+        // Off for headless runs unless asked for, their frames have to match the golden images
+        std::unique_ptr<ShaderReloader> shaderReloader;
+        if (options.hotReload || !options.headless) {
+#ifdef LEARNOPENGL_HEADLESS
+            const auto loader = options.headless ? reinterpret_cast<GLADloadproc>(eglGetProcAddress)
+                                                 : reinterpret_cast<GLADloadproc>(glfwGetProcAddress);
+#else
+            const auto loader = reinterpret_cast<GLADloadproc>(glfwGetProcAddress);
+#endif
+            shaderReloader = std::make_unique<ShaderReloader>(loader);
+        }
+        // Shares shaders, textures and meshes between materials, GL objects are freed with their last user
+        ResourceCache resources(textureLoader, &programCache, shaderReloader.get());
+        // Quads take turns using every image in the textures directory
+        const std::vector<std::string> texturePaths = listTextures("../textures");
+        std::unique_ptr<TextureAtlas> atlas;
+        if (options.atlas) {
+            // One block compressed texture for all of them, so they share a texture bind and a draw call.
+            // It's cached on disk, later launches skip decoding and compressing
+            atlas = std::make_unique<TextureAtlas>(texturePaths);
+            std::cout << atlas->getStats() << std::endl;
+        }
+        // Every quad is an entity, its components live in one array each
+        SceneStore scene;
+        addQuadGrid(scene, vertices, sizeof(vertices), resources, options.meshPath, atlas.get(), texturePaths,
+                    options.quadCount);
+        const SceneBounds bounds;
+        // Only quads overlapping the viewport are drawn, it's [-1, 1] in clip space
+        const SceneBounds view;
+        // Headless runs tick once per frame with a fixed step so every run renders exactly the same frames
+        const bool lockstep = options.headless || options.lockstep;
+        // Update and culling run at a fixed tick rate on their own thread, as SIMD kernels spread over a pool
+        SimulationThread simulation(scene, bounds, view, options.headless ? 1.0 / options.fixedStep : options.tickRate);
+        simulation.setArtificialLoad(options.simLoadMs);
+        std::cout << "scene update: " << simdLevelName(detectSimdLevel()) << " on " << simulation.getThreadCount()
+                  << " threads, " << 1.0 / simulation.getTickSeconds() << " ticks/s" << (lockstep ? " in lockstep" : "")
+                  << std::endl;
+
+        BatchRenderer batch;
+        batch.setBatching(options.batched);
+        auto lastStatsTime = std::chrono::steady_clock::now();
+        bool firstFrame = true;
+        // Per frame CPU scopes and GPU timer queries
+        Profiler profiler;
+
+        // Headless frames go to an FBO and are read back a few frames later through PBOs
+        std::unique_ptr<OffscreenTarget> offscreen;
+        std::unique_ptr<FrameReadback> readback;
+        if (options.headless) {
+            offscreen = std::make_unique<OffscreenTarget>(options.width, options.height);
+            readback = std::make_unique<FrameReadback>(options.width, options.height);
+            offscreen->bind();
+            // Captures have to be identical from run to run, so don't start on the placeholder texture
+            while (!textureLoader.idle()) {
+                textureLoader.update();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            textureLoader.update();
+        }
+        if (!lockstep) {
+            simulation.start();
+        }
+        const auto loopBegin = std::chrono::steady_clock::now();
+        unsigned int frameIndex = 0;
+
+        // Render loop
+        while (options.headless ? frameIndex < options.frames : !glfwWindowShouldClose(window)) {
+            profiler.beginFrame();
+            if (window != nullptr) {
+                PROFILE_SCOPE(profiler, "processInput");
+                // Process input
+                processInput(window);
+            }
+            {
+                PROFILE_SCOPE(profiler, "textureUpload");
+                // Upload any textures the loader threads have finished decoding
+                textureLoader.update();
+            }
+            if (shaderReloader) {
+                PROFILE_SCOPE(profiler, "shaderReload");
+                // Swap in shaders the driver has finished recompiling since the last frame
+                shaderReloader->update();
+            }
+            {
+                PROFILE_GPU_SCOPE(profiler, "clear");
+                // Render commands
+                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+            }
+            if (lockstep) {
+                PROFILE_SCOPE(profiler, "updateScene");
+                // Move every entity, bounce it off the edges of the screen and collect the visible ones
+                simulation.step();
+            }
+            {
+                PROFILE_SCOPE(profiler, "drawScene");
+                // Write the newest snapshot's entities into the batch, blended between its last two ticks,
+                // then draw them grouped by shader + texture
+                if (simulation.acquire()) {
+                    const SceneSnapshot &snapshot = simulation.latest();
+                    submitInterpolated(batch, scene, snapshot, simulation.interpolation(snapshot));
+                }
+                PROFILE_GPU_SCOPE(profiler, "batchFlush");
+                batch.flush();
+            }
+            if (options.renderLoadMs > 0.0) {
+                PROFILE_SCOPE(profiler, "renderLoad");
+                const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(options.renderLoadMs);
+                while (std::chrono::steady_clock::now() < until) {
+                }
+            }
+
+            // Report submission cost and frame time percentiles once a second
+            if (!options.headless && std::chrono::steady_clock::now() - lastStatsTime >= std::chrono::seconds(1)) {
+                printBatchStats(batch.getStats());
+                std::cout << resources.getStats() << std::endl;
+                std::cout << simulation.getStats() << std::endl;
+                profiler.printSummary(std::cout);
+                lastStatsTime = std::chrono::steady_clock::now();
+            }
+
+            if (options.headless) {
+                PROFILE_SCOPE(profiler, "readback");
+                const bool lastFrame = frameIndex + 1 == options.frames;
+                if (lastFrame || (options.captureEvery > 0 && frameIndex % options.captureEvery == 0)) {
+                    readback->capture(frameIndex);
+                }
+                CapturedFrame captured;
+                while (readback->poll(captured)) {
+                    goldensMatch &= checkCapture(captured, options);
+                }
+            } else {
+                PROFILE_SCOPE(profiler, "swapBuffers");
+                // Check/call events and swap the buffers
+                glfwPollEvents();
+                glfwSwapBuffers(window);
+            }
+            profiler.endFrame();
+            frameIndex++;
+
+            // Startup cost, run twice to compare a cold and a warm program cache
+            if (firstFrame) {
+                firstFrame = false;
+                const double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegin).count();
+                std::cout << "startup: " << startupMs << " ms to first frame, " << programCache.getStats() << std::endl;
+            }
+        }
 
-        // Update triangle
-        updateTriangle(drawableTriangle1);
-        // Draw triangle one
-        drawTriangle(drawableTriangle1);
+        if (options.headless) {
+            CapturedFrame captured;
+            while (readback->wait(captured)) {
+                goldensMatch &= checkCapture(captured, options);
+            }
+            const double loopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loopBegin).count();
+            const FrameReadbackStats &readbackStats = readback->getStats();
+            std::cout << "headless: " << frameIndex << " frames at " << options.width << "x" << options.height
+                      << " in " << loopMs << " ms, " << frameIndex / (loopMs / 1000.0) << " fps" << std::endl;
+            std::cout << "readback: " << readbackStats.completed << " frames, " << readbackStats.stalls << " stalls, "
+                      << readbackStats.waitMs << " ms waiting, " << readbackStats.copyMs << " ms copying" << std::endl;
+            printBatchStats(batch.getStats());
+            std::cout << resources.getStats() << std::endl;
+            if (atlas) {
+                std::cout << atlas->getStats() << std::endl;
+            }
+            if (shaderReloader) {
+                std::cout << shaderReloader->getStats() << std::endl;
+            }
+            std::cout << simulation.getStats() << std::endl;
+            profiler.printSummary(std::cout);
+        }
+        simulation.stop();
+
+        if (!options.tracePath.empty()) {
+            if (profiler.writeChromeTrace(options.tracePath)) {
+                std::cout << "Wrote trace of the last frames to " << options.tracePath << std::endl;
+            } else {
+                std::cout << "Failed to write trace " << options.tracePath << std::endl;
+            }
+        }
+    } // everything GL related is released here, while the context still exists
 
-        // Check/call events and swap the buffers
-        glfwPollEvents();
-        glfwSwapBuffers(window);
+    // Clean up GLFW / EGL
+    if (window != nullptr) {
+        glfwTerminate();
+    }
+#ifdef LEARNOPENGL_HEADLESS
+    headlessContext.destroy();
+#endif
+    if (!goldensMatch) {
+        std::cout << "Rendered frames don't match the golden images" << std::endl;
+        exit(EXIT_FAILURE);
     }
-
-    // Clean up GLFW
-    glfwTerminate();
     exit(EXIT_SUCCESS);
 }
 
 #pragma region main application functions
 
-GLFWwindow* createWindow() {
-    const int width = 800;
-    const int height = 600;
+AppOptions parseOptions(int argc, char** argv) {
+    const char* usage =
+        "usage: LearnOpenGL [quad count] [--unbatched] [--atlas] [--mesh file.lmesh] [--move] [--trace trace.json]\n"
+        "       [--hot-reload] [--headless] [--frames N] [--step seconds] [--size WxH] [--capture-every N]\n"
+        "       [--out dir] [--golden dir] [--update-golden] [--tolerance 0-255]\n"
+        "       [--tick-rate hz] [--lockstep] [--sim-load ms] [--render-load ms]";
+    AppOptions options;
+    for (int i = 1; i < argc; i++) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--unbatched") == 0) {
+            options.batched = false;
+        } else if (std::strcmp(argv[i], "--atlas") == 0) {
+            options.atlas = true;
+        } else if (std::strcmp(argv[i], "--mesh") == 0 && hasValue) {
+            options.meshPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--hot-reload") == 0) {
+            options.hotReload = true;
+        } else if (std::strcmp(argv[i], "--move") == 0) {
+            MOVE_ENABLED = true;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            options.headless = true;
+        } else if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options.frames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--step") == 0 && hasValue) {
+            options.fixedStep = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+            std::sscanf(argv[++i], "%dx%d", &options.width, &options.height);
+        } else if (std::strcmp(argv[i], "--capture-every") == 0 && hasValue) {
+            options.captureEvery = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--out") == 0 && hasValue) {
+            options.outputDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--golden") == 0 && hasValue) {
+            options.goldenDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--update-golden") == 0) {
+            options.updateGolden = true;
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && hasValue) {
+            options.tolerance = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tick-rate") == 0 && hasValue) {
+            options.tickRate = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--lockstep") == 0) {
+            options.lockstep = true;
+        } else if (std::strcmp(argv[i], "--sim-load") == 0 && hasValue) {
+            options.simLoadMs = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--render-load") == 0 && hasValue) {
+            options.renderLoadMs = std::strtod(argv[++i], nullptr);
+        } else {
+            // anything else has to be the quad count, a typo'd option or missing value shouldn't turn into 0 quads
+            char* end = nullptr;
+            const unsigned long count = std::strtoul(argv[i], &end, 10);
+            if (argv[i][0] < '0' || argv[i][0] > '9' || *end != '\0') {
+                std::cout << "Unknown option " << argv[i] << "\n" << usage << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            options.quadCount = static_cast<unsigned int>(count);
+        }
+    }
+    if (options.frames == 0 || options.width <= 0 || options.height <= 0 || options.fixedStep <= 0.0 || options.tickRate <= 0.0) {
+        std::cout << "Invalid --frames, --size, --step or --tick-rate, exiting...\n" << usage << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return options;
+}
+
+GLFWwindow* createWindow(bool visible, int width, int height) {
+    // Initialize the glfw window library
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    // Run OpenGL with the Core profile
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
+
     // Create the window object
-    GLFWwindow* window = glfwCreateWindow(800, 600, "LearnOpenGL", nullptr, nullptr);
+    GLFWwindow* window = glfwCreateWindow(width, height, "LearnOpenGL", nullptr, nullptr);
 
     // Make sure the window was created successfully
     if (window == nullptr) {
@@ -95,7 +402,18 @@ GLFWwindow* createWindow() {
     };
 
     // Register window resize callback function
-    glfwSetFramebufferSizeCallback(window, resizeWindowCallback);
+    if (visible) {
+        glfwSetFramebufferSizeCallback(window, resizeWindowCallback);
+    }
+    glfwMakeContextCurrent(window);
+
+    // Load GLAD
+    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress))) {
+        std::cout << "Failed to load GLAD, exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    // glad skips extensions, the stream buffer can still map persistently through ARB_buffer_storage
+    loadBufferStorageExtension(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
 
     return window;
 }
@@ -108,101 +426,145 @@ void processInput(GLFWwindow* window) {
     }
 }
 
+// writes a captured frame and checks it against its golden image, false on a mismatch
+bool checkCapture(const CapturedFrame &frame, const AppOptions &options) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%05llu", static_cast<unsigned long long>(frame.frame));
+    if (!options.outputDir.empty()) {
+        writePPM(options.outputDir + "/" + name + ".ppm", frame);
+    }
+    if (options.goldenDir.empty()) {
+        return true;
+    }
+    const std::string goldenPath = options.goldenDir + "/" + name + ".ppm";
+    if (options.updateGolden) {
+        return writePPM(goldenPath, frame);
+    }
+
+    CapturedFrame golden;
+    if (!readImage(goldenPath, golden)) {
+        std::cout << name << ": no golden image at " << goldenPath << std::endl;
+        return false;
+    }
+    const ImageDiff diff = compareImages(frame, golden, options.tolerance);
+    if (!diff.sizeMatches) {
+        std::cout << name << ": size " << frame.width << "x" << frame.height << " doesn't match the golden "
+                  << golden.width << "x" << golden.height << std::endl;
+        return false;
+    }
+    std::cout << name << ": " << diff.differingPixels << " pixels differ, max difference " << diff.maxDifference
+              << ", mean " << diff.meanDifference << std::endl;
+    if (diff.differingPixels == 0) {
+        return true;
+    }
+    if (!options.outputDir.empty()) {
+        writePPM(options.outputDir + "/" + name + "_diff.ppm", CapturedFrame{frame.frame, frame.width, frame.height, diff.mask});
+    }
+    return false;
+}
+
 #pragma endregion
 
 // ****** //
 // SHAPES //
 // ****** //
 
-void drawTriangle(const Triangle &triangle) {
-    triangle.shaderProgram.use();
-    glBindTexture(GL_TEXTURE_2D, triangle.texture);
-    glBindVertexArray(triangle.VAO); // bind the VAO containing the VBO and EBO
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0); // draw elements based on EBO
-    glBindVertexArray(0); // unbind
+void printBatchStats(const BatchStats &stats) {
+    std::cout << "quads: " << stats.instances
+              << " groups: " << stats.groups
+              << " draw calls: " << stats.drawCalls
+              << " binds (program/texture/vao): " << stats.programBinds << "/" << stats.textureBinds << "/" << stats.vaoBinds
+              << " " << stats.calls << ", " << stats.attributeSetups << " attribute setups"
+              << " sort: " << stats.sortPasses << " passes, " << stats.sortMs << " ms"
+              << " submit: " << stats.submitMs << " ms" << std::endl;
 }
 
-
-float x_speed = 0.01f;
-float y_speed = 0.005f;
-
-void updateTriangle(const Triangle triangle) {
-    int posOffsetLocation = glGetUniformLocation(triangle.shaderProgram.getId(), "posOffset");
-    float current_offset[3];
-    glGetUniformfv(triangle.shaderProgram.getId(), posOffsetLocation, current_offset);
-    if (MOVE_ENABLED) {
-        if (current_offset[0] > 1.0f || current_offset[0] <= -1.0f) {
-            x_speed *= -1;
+// image files in directory, sorted so the quads get the same texture on every launch
+std::vector<std::string> listTextures(const std::string &directory) {
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        if (entry.is_regular_file() && (extension == ".jpg" || extension == ".jpeg" || extension == ".png" ||
+                                        extension == ".bmp" || extension == ".tga" || extension == ".ppm")) {
+            paths.push_back(entry.path().generic_string());
         }
-        if (current_offset[1] > 1.0f || current_offset[1] <= -1.0f) {
-            y_speed *= -1;
-        }
-        glUniform3f(posOffsetLocation, current_offset[0] + x_speed, current_offset[1] + y_speed, current_offset[2]);
-        glUseProgram(triangle.shaderProgram.getId());
     }
+    std::sort(paths.begin(), paths.end());
+    if (paths.empty()) {
+        // shows up as the placeholder, along with the loader's error message
+        paths.push_back(directory + "/wall.jpg");
+    }
+    return paths;
 }
 
-Triangle getDrawableTriangle(const float* vertices, size_t vertexSize) {
-    unsigned int VBO, EBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertexSize, vertices, GL_STATIC_DRAW);
-
+void addQuadGrid(SceneStore &scene, const float* vertices, size_t vertexSize, ResourceCache &resources,
+                 const std::string &meshPath, const TextureAtlas* atlas, const std::vector<std::string> &texturePaths,
+                 unsigned int count) {
     // Define the indices for two triangles forming a square
     unsigned int indices[] = {
         0, 1, 3,  // first triangle (top-right, bottom-right, top-left)
         1, 2, 3   // second triangle (bottom-right, bottom-left, top-left)
     };
 
-    // Create and bind EBO
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-    Shader myShader("../shaders/vertex_shader.vs", "../shaders/fragment_shader.fs");
-
-    // Set up the texture
-    unsigned int texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    int width, height, nrChannels;
-    unsigned char *data = stbi_load("../textures/wall.jpg", &width, &height, &nrChannels, 0);
-    if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "Failed to load texture" << std::endl;
-    }
-    stbi_image_free(data);
-
-    // Create the Vertex Array Object (VAO) and bind it
-    unsigned int VAO;
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-
-    // Bind VBO, EBO and set attribute pointers
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    return Triangle{myShader, texture, VBO, VAO, EBO};  // Updated Triangle to include EBO
-}
-
-
-
-
-
-
+    // Identical requests return the already created VAO/VBO/EBO, program and texture
+    std::shared_ptr<Mesh> mesh = resources.getMesh(vertices, vertexSize, indices, sizeof(indices));
+    if (!meshPath.empty()) {
+        // The file is memory mapped and uploaded straight from the mapping, the quad stays as the fallback
+        if (std::shared_ptr<Mesh> loaded = resources.getMeshFile(meshPath)) {
+            mesh = std::move(loaded);
+        }
+    }
+    std::shared_ptr<Shader> shader = resources.getShader("../shaders/vertex_shader.vs", "../shaders/fragment_shader.fs");
+    // Either one rect of the atlas per image, or separate textures decoded on the texture loader's worker threads
+    std::vector<uint32_t> textures;
+    for (const std::string &path : texturePaths) {
+        if (atlas != nullptr) {
+            const int index = atlas->find(path);
+            textures.push_back(scene.addTexture(atlas->getTexture(),
+                                                index >= 0 ? atlas->getRect(static_cast<size_t>(index)) : TextureRect{}));
+        } else {
+            textures.push_back(scene.addTexture(resources.getTexture(path)));
+        }
+    }
 
+    EntityDesc desc;
+    desc.material = scene.addMaterial(shader, mesh);
+    desc.texture = textures[0];
+    scene.reserve(count);
+    if (count == 1) {
+        if (MOVE_ENABLED) {
+            desc.velocity[0] = 0.6f;
+            desc.velocity[1] = 0.3f;
+        }
+        scene.create(desc);
+        return;
+    }
+    // lay the quads out in a square grid covering the viewport
+    const auto side = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const float cell = 2.0f / static_cast<float>(side);
+    desc.scale = cell * 0.9f;
+    for (unsigned int i = 0; i < count; i++) {
+        const unsigned int col = i % side;
+        const unsigned int row = i / side;
+        desc.position[0] = -1.0f + cell * (static_cast<float>(col) + 0.5f);
+        desc.position[1] = -1.0f + cell * (static_cast<float>(row) + 0.5f);
+        const float r = static_cast<float>(col) / static_cast<float>(side);
+        const float g = static_cast<float>(row) / static_cast<float>(side);
+        desc.color[0] = r;
+        desc.color[1] = g;
+        desc.color[2] = 1.0f - r;
+        desc.texture = textures[i % textures.size()];
+        if (MOVE_ENABLED) {
+            // spread the directions with the golden angle, speeds between 0.3 and 0.6 units per second
+            const float angle = static_cast<float>(i) * 2.39996f;
+            const float speed = 0.3f + 0.05f * static_cast<float>(i % 7);
+            desc.velocity[0] = std::cos(angle) * speed;
+            desc.velocity[1] = std::sin(angle) * speed;
+        }
+        scene.create(desc);
+    }
+}
@@ -0,0 +1,337 @@
+#ifndef LEARNOPENGL_PROFILER_H
+#define LEARNOPENGL_PROFILER_H
+
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// one timed section of a frame, times are microseconds since the profiler was created
+struct ProfileEvent {
+    const char* name; // must outlive the profiler, string literals in practice
+    int depth;
+    double startUs;
+    double durationUs;
+};
+
+struct ProfileFrame {
+    uint64_t index = 0;
+    double startUs = 0.0;
+    double durationUs = 0.0;
+    std::vector<ProfileEvent> cpu;
+    std::vector<ProfileEvent> gpu; // filled in a few frames late, once the queries are available
+};
+
+struct ProfilePercentiles {
+    size_t samples = 0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Frame profiler with RAII CPU scopes and GL_TIME_ELAPSED GPU scopes.
+// GPU queries are only read back QUERY_LATENCY frames after they were issued,
+// and only if the driver says the result is available, so they never stall.
+// Completed frames are kept in a ring buffer for percentiles and trace export.
+class Profiler {
+private:
+    static constexpr int QUERY_LATENCY = 4;
+
+    struct PendingQuery {
+        unsigned int query;
+        const char* name;
+        int depth;
+        double startUs; // CPU time the query was issued at, used to place it in traces
+    };
+    struct QueryFrame {
+        uint64_t frameIndex = 0;
+        std::vector<PendingQuery> queries;
+    };
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    std::vector<ProfileFrame> history;
+    size_t historyCapacity;
+    size_t historyNext = 0;
+    ProfileFrame current;
+    bool inFrame = false;
+    int depth = 0;
+    uint64_t frameIndex = 0;
+
+    QueryFrame queryFrames[QUERY_LATENCY];
+    std::vector<unsigned int> freeQueries;
+    bool gpuScopeOpen = false; // GL_TIME_ELAPSED queries can't be nested
+    unsigned int droppedQueries = 0;
+
+    ProfileFrame* findFrame(uint64_t index) {
+        for (ProfileFrame &frame : history) {
+            if (frame.index == index && frame.durationUs > 0.0) {
+                return &frame;
+            }
+        }
+        return nullptr;
+    }
+
+    // collect the queries issued QUERY_LATENCY frames ago
+    void resolveQueries(QueryFrame &slot) {
+        ProfileFrame* frame = findFrame(slot.frameIndex);
+        const double resolvedUs = nowUs();
+        for (const PendingQuery &pending : slot.queries) {
+            int available = 0;
+            glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 elapsedNs = 0;
+                glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &elapsedNs);
+                // the GPU can't have spent longer on the scope than has passed since it was issued,
+                // Mesa llvmpipe for one reports a raw timestamp for the first query of a context
+                const double elapsedUs = static_cast<double>(elapsedNs) / 1000.0;
+                if (elapsedUs > resolvedUs - pending.startUs) {
+                    droppedQueries++;
+                } else if (frame) {
+                    frame->gpu.push_back(ProfileEvent{pending.name, pending.depth, pending.startUs, elapsedUs});
+                }
+                freeQueries.push_back(pending.query);
+            } else {
+                // still in flight: drop the result instead of waiting for it, reusing the
+                // query later simply discards the old result
+                droppedQueries++;
+                freeQueries.push_back(pending.query);
+            }
+        }
+        slot.queries.clear();
+    }
+
+    static void writeEvent(std::ostream &out, bool &first, const char* name, const char* category, int thread,
+                           double startUs, double durationUs) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << R"(  {"name": ")" << name << R"(", "cat": ")" << category << R"(", "ph": "X", "pid": 1, "tid": )"
+            << thread << R"(, "ts": )" << startUs << R"(, "dur": )" << durationUs << "}";
+    }
+
+public:
+    // p50/p95/p99/max of any set of samples
+    static ProfilePercentiles percentiles(std::vector<double> values) {
+        ProfilePercentiles result;
+        result.samples = values.size();
+        if (values.empty()) {
+            return result;
+        }
+        std::sort(values.begin(), values.end());
+        auto at = [&values](double p) {
+            const auto index = static_cast<size_t>(p * static_cast<double>(values.size() - 1) + 0.5);
+            return values[index];
+        };
+        result.p50 = at(0.50);
+        result.p95 = at(0.95);
+        result.p99 = at(0.99);
+        result.max = values.back();
+        return result;
+    }
+
+    // historyFrames is how many completed frames are kept for percentiles and traces
+    explicit Profiler(size_t historyFrames = 600) : historyCapacity(std::max<size_t>(1, historyFrames)) {
+        history.reserve(historyCapacity);
+    }
+
+    ~Profiler() {
+        for (QueryFrame &slot : queryFrames) {
+            for (const PendingQuery &pending : slot.queries) {
+                freeQueries.push_back(pending.query);
+            }
+        }
+        if (!freeQueries.empty()) {
+            glDeleteQueries(static_cast<GLsizei>(freeQueries.size()), freeQueries.data());
+        }
+    }
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    [[nodiscard]] double nowUs() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    void beginFrame() {
+        QueryFrame &slot = queryFrames[frameIndex % QUERY_LATENCY];
+        resolveQueries(slot);
+        slot.frameIndex = frameIndex;
+
+        current = ProfileFrame{};
+        current.index = frameIndex;
+        current.startUs = nowUs();
+        inFrame = true;
+        depth = 0;
+    }
+
+    void endFrame() {
+        if (!inFrame) {
+            return;
+        }
+        current.durationUs = nowUs() - current.startUs;
+        if (history.size() < historyCapacity) {
+            history.push_back(std::move(current));
+        } else {
+            history[historyNext] = std::move(current);
+        }
+        historyNext = (historyNext + 1) % historyCapacity;
+        inFrame = false;
+        frameIndex++;
+    }
+
+    // used by ProfileScope / GpuProfileScope
+    int pushScope() {
+        return depth++;
+    }
+    void popScope(const char* name, int scopeDepth, double startUs) {
+        depth--;
+        if (inFrame) {
+            current.cpu.push_back(ProfileEvent{name, scopeDepth, startUs, nowUs() - startUs});
+        }
+    }
+    // returns the query to end, 0 if the scope can't be timed (nested or outside a frame)
+    // expects the matching CPU scope to be open already
+    unsigned int beginGpuQuery(const char* name) {
+        if (!inFrame || gpuScopeOpen) {
+            return 0;
+        }
+        unsigned int query = 0;
+        if (freeQueries.empty()) {
+            glGenQueries(1, &query);
+        } else {
+            query = freeQueries.back();
+            freeQueries.pop_back();
+        }
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        gpuScopeOpen = true;
+        queryFrames[frameIndex % QUERY_LATENCY].queries.push_back(PendingQuery{query, name, std::max(0, depth - 1), nowUs()});
+        return query;
+    }
+    void endGpuQuery(unsigned int query) {
+        if (query != 0) {
+            glEndQuery(GL_TIME_ELAPSED);
+            gpuScopeOpen = false;
+        }
+    }
+
+    // frames in chronological order
+    [[nodiscard]] std::vector<const ProfileFrame*> getFrames() const {
+        std::vector<const ProfileFrame*> frames;
+        frames.reserve(history.size());
+        const size_t start = history.size() < historyCapacity ? 0 : historyNext;
+        for (size_t i = 0; i < history.size(); i++) {
+            frames.push_back(&history[(start + i) % history.size()]);
+        }
+        return frames;
+    }
+
+    [[nodiscard]] ProfilePercentiles frameTimes() const {
+        std::vector<double> values;
+        for (const ProfileFrame &frame : history) {
+            values.push_back(frame.durationUs / 1000.0);
+        }
+        return percentiles(std::move(values));
+    }
+
+    // per scope name, times in milliseconds summed per frame
+    [[nodiscard]] std::map<std::string, ProfilePercentiles> scopeTimes(bool gpu = false) const {
+        std::map<std::string, std::vector<double>> values;
+        for (const ProfileFrame &frame : history) {
+            std::map<std::string, double> perFrame;
+            for (const ProfileEvent &event : gpu ? frame.gpu : frame.cpu) {
+                perFrame[event.name] += event.durationUs / 1000.0;
+            }
+            for (const auto &entry : perFrame) {
+                values[entry.first].push_back(entry.second);
+            }
+        }
+        std::map<std::string, ProfilePercentiles> result;
+        for (auto &entry : values) {
+            result[entry.first] = percentiles(std::move(entry.second));
+        }
+        return result;
+    }
+
+    void printSummary(std::ostream &out) const {
+        const ProfilePercentiles frame = frameTimes();
+        out << "frame: p50 " << frame.p50 << " ms, p95 " << frame.p95 << " ms, p99 " << frame.p99
+            << " ms, max " << frame.max << " ms over " << frame.samples << " frames" << std::endl;
+        for (const bool gpu : {false, true}) {
+            for (const auto &entry : scopeTimes(gpu)) {
+                out << "  " << (gpu ? "gpu " : "cpu ") << entry.first << ": p50 " << entry.second.p50
+                    << " ms, p95 " << entry.second.p95 << " ms, p99 " << entry.second.p99 << " ms" << std::endl;
+            }
+        }
+        if (droppedQueries > 0) {
+            out << "  " << droppedQueries << " GPU queries weren't ready in time or reported impossible times"
+                << " and were dropped" << std::endl;
+        }
+    }
+
+    // Chrome trace event format, open in chrome://tracing or ui.perfetto.dev
+    // CPU scopes go on thread 1, GPU scopes on thread 2 aligned to when they were issued
+    bool writeChromeTrace(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out) {
+            return false;
+        }
+        bool first = true;
+        out << "[";
+        for (const ProfileFrame* frame : getFrames()) {
+            writeEvent(out, first, "frame", "frame", 0, frame->startUs, frame->durationUs);
+            for (const ProfileEvent &event : frame->cpu) {
+                writeEvent(out, first, event.name, "cpu", 1, event.startUs, event.durationUs);
+            }
+            for (const ProfileEvent &event : frame->gpu) {
+                writeEvent(out, first, event.name, "gpu", 2, event.startUs, event.durationUs);
+            }
+        }
+        out << "\n]\n";
+        return static_cast<bool>(out);
+    }
+};
+
+// times the enclosing block on the CPU
+class ProfileScope {
+private:
+    Profiler &profiler;
+    const char* name;
+    int depth;
+    double startUs;
+public:
+    ProfileScope(Profiler &profiler, const char* name)
+        : profiler(profiler), name(name), depth(profiler.pushScope()), startUs(profiler.nowUs()) {}
+    ~ProfileScope() {
+        profiler.popScope(name, depth, startUs);
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+// times the enclosing block on the CPU and the GL commands it issues on the GPU
+class GpuProfileScope {
+private:
+    ProfileScope cpuScope;
+    Profiler &profiler;
+    unsigned int query;
+public:
+    GpuProfileScope(Profiler &profiler, const char* name)
+        : cpuScope(profiler, name), profiler(profiler), query(profiler.beginGpuQuery(name)) {}
+    ~GpuProfileScope() {
+        profiler.endGpuQuery(query);
+    }
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(profiler, name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, name)
+#define PROFILE_GPU_SCOPE(profiler, name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(profiler, name)
+
+#endif //LEARNOPENGL_PROFILER_H
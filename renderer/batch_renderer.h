@@ -0,0 +1,301 @@
+#ifndef LEARNOPENGL_BATCH_RENDERER_H
+#define LEARNOPENGL_BATCH_RENDERER_H
+
+#include <glad/glad.h>
+#include "renderer/stream_buffer.h"
+#include "renderer/gl_state_cache.h"
+#include "renderer/render_queue.h"
+#include "structs/vertex_layout.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+// per-instance data streamed to the GPU, must match the instanced vertex shader
+// layout (location = 3) vec4 aInstanceOffset (xyz offset, w scale)
+// layout (location = 4) vec4 aInstanceColor
+// layout (location = 5) vec4 aInstanceTexRect (xy offset, zw size of the image inside its texture)
+struct QuadInstance {
+    float offset[3];
+    float scale;
+    float color[4];
+    float texRect[4] = {0.0f, 0.0f, 1.0f, 1.0f}; // the whole texture unless it's an atlas
+};
+
+// counters for the last flush, used to compare batched vs unbatched submission
+struct BatchStats {
+    unsigned int groups = 0;
+    unsigned int drawCalls = 0;
+    unsigned int instances = 0;
+    unsigned int programBinds = 0; // binds that reached the driver, redundant ones are in calls.elided
+    unsigned int textureBinds = 0;
+    unsigned int vaoBinds = 0;
+    unsigned int sortPasses = 0;   // radix passes over the draw commands, 0 when nothing needed sorting
+    unsigned int attributeSetups = 0; // instance attributes re-pointed, 9 calls each, not part of calls
+    GLCallStats calls;
+    double sortMs = 0.0;
+    double submitMs = 0.0; // CPU time spent inside flush()
+};
+
+// Collects quads for a frame and draws every quad sharing the same
+// shader + texture + VAO with a single glDrawElementsInstanced call.
+// The draws go through a RenderQueue sorted by state and a GLStateCache,
+// so binds only happen when the program, texture or VAO actually changes.
+class BatchRenderer {
+private:
+    static constexpr unsigned int INSTANCE_OFFSET_LOCATION = VertexLayout::FIRST_INSTANCE_LOCATION;
+    static constexpr unsigned int INSTANCE_COLOR_LOCATION = VertexLayout::FIRST_INSTANCE_LOCATION + 1;
+    static constexpr unsigned int INSTANCE_TEX_RECT_LOCATION = VertexLayout::FIRST_INSTANCE_LOCATION + 2;
+    static_assert(VertexLayout::INSTANCE_LOCATIONS == 3, "every instance attribute needs a reserved location");
+
+    struct Group {
+        unsigned int program;
+        unsigned int texture;
+        unsigned int VAO;
+        unsigned int indexCount;
+        unsigned int indexType;
+        std::vector<QuadInstance> instances;
+    };
+    // instances [first, first + count) of the stream buffer region, drawn with a group's state
+    struct DrawRange {
+        uint32_t group;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    std::vector<Group> groups;
+    std::unordered_map<uint64_t, size_t> groupLookup;
+    std::vector<DrawRange> draws;
+    RenderQueue queue;
+    GLStateCache state;
+    StreamBuffer instanceBuffer{GL_ARRAY_BUFFER, 64 * 1024};
+    bool batching = true;
+    bool sorting = true;
+    // GL 4.2 draws take a base instance, so a VAO's instance attributes only need pointing once per frame
+    const bool baseInstance = GLAD_GL_VERSION_4_2 != 0;
+    std::vector<unsigned int> pointedVAOs; // VAOs whose instance attributes point at attributesBase
+    uintptr_t attributesBase = 0;
+    BatchStats stats;
+
+    static uint64_t makeKey(unsigned int program, unsigned int texture, unsigned int VAO) {
+        // programs, textures and VAOs are small integers, 21 bits each is plenty
+        return (static_cast<uint64_t>(program & 0x1FFFFF) << 42) |
+               (static_cast<uint64_t>(texture & 0x1FFFFF) << 21) |
+               static_cast<uint64_t>(VAO & 0x1FFFFF);
+    }
+
+    // point the instance attributes of the currently bound VAO at the instance stored at byte offset base,
+    // skipped when they already point there
+    void bindInstanceAttributes(unsigned int VAO, uintptr_t base) {
+        if (base != attributesBase) {
+            pointedVAOs.clear();
+            attributesBase = base;
+        }
+        if (std::find(pointedVAOs.begin(), pointedVAOs.end(), VAO) != pointedVAOs.end()) {
+            return;
+        }
+        pointedVAOs.push_back(VAO);
+        stats.attributeSetups++;
+        state.bindBuffer(GL_ARRAY_BUFFER, instanceBuffer.getBuffer());
+        glVertexAttribPointer(INSTANCE_OFFSET_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance),
+                              reinterpret_cast<void*>(base + offsetof(QuadInstance, offset)));
+        glEnableVertexAttribArray(INSTANCE_OFFSET_LOCATION);
+        glVertexAttribDivisor(INSTANCE_OFFSET_LOCATION, 1);
+        glVertexAttribPointer(INSTANCE_COLOR_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance),
+                              reinterpret_cast<void*>(base + offsetof(QuadInstance, color)));
+        glEnableVertexAttribArray(INSTANCE_COLOR_LOCATION);
+        glVertexAttribDivisor(INSTANCE_COLOR_LOCATION, 1);
+        glVertexAttribPointer(INSTANCE_TEX_RECT_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(QuadInstance),
+                              reinterpret_cast<void*>(base + offsetof(QuadInstance, texRect)));
+        glEnableVertexAttribArray(INSTANCE_TEX_RECT_LOCATION);
+        glVertexAttribDivisor(INSTANCE_TEX_RECT_LOCATION, 1);
+    }
+
+    Group &findGroup(unsigned int program, unsigned int texture, unsigned int VAO, unsigned int indexCount,
+                     unsigned int indexType) {
+        const uint64_t key = makeKey(program, texture, VAO);
+        auto it = groupLookup.find(key);
+        if (it == groupLookup.end()) {
+            it = groupLookup.emplace(key, groups.size()).first;
+            groups.push_back(Group{program, texture, VAO, indexCount, indexType, {}});
+        }
+        Group &group = groups[it->second];
+        // GL reuses the names of deleted VAOs, so a group can outlive its mesh and be found again for
+        // a new one. A VAO only ever has one element buffer, the latest caller's index data is right
+        group.indexCount = indexCount;
+        group.indexType = indexType;
+        return group;
+    }
+
+    // drop groups nothing was queued for since the last flush, their objects may not even exist anymore
+    void removeIdleGroups() {
+        const auto idle = [](const Group &group) { return group.instances.empty(); };
+        if (std::none_of(groups.begin(), groups.end(), idle)) {
+            return;
+        }
+        groups.erase(std::remove_if(groups.begin(), groups.end(), idle), groups.end());
+        groupLookup.clear();
+        for (size_t i = 0; i < groups.size(); i++) {
+            groupLookup.emplace(makeKey(groups[i].program, groups[i].texture, groups[i].VAO), i);
+        }
+    }
+
+public:
+    BatchRenderer() = default;
+
+    BatchRenderer(const BatchRenderer&) = delete;
+    BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+    // when disabled every quad is drawn on its own, handy for A/B measurements
+    void setBatching(bool enabled) {
+        batching = enabled;
+    }
+
+    [[nodiscard]] bool isBatching() const {
+        return batching;
+    }
+
+    // when disabled draws go out in the order their groups were first used
+    void setSorting(bool enabled) {
+        sorting = enabled;
+    }
+
+    // when disabled every bind reaches the driver, even if it changes nothing
+    void setStateCache(bool enabled) {
+        state.setEnabled(enabled);
+    }
+
+    // queue a quad for this frame, VAO must have an element buffer bound holding indices of indexType
+    void submit(unsigned int program, unsigned int texture, unsigned int VAO, unsigned int indexCount,
+                unsigned int indexType, const QuadInstance &instance) {
+        findGroup(program, texture, VAO, indexCount, indexType).instances.push_back(instance);
+    }
+
+    // queue count quads at once and return where to write them, lets callers fill
+    // instance data in place instead of going through submit() one quad at a time.
+    // The pointer stays valid until more quads are added to the same group or flush() runs.
+    QuadInstance* allocate(unsigned int program, unsigned int texture, unsigned int VAO, unsigned int indexCount,
+                           unsigned int indexType, size_t count) {
+        std::vector<QuadInstance> &instances = findGroup(program, texture, VAO, indexCount, indexType).instances;
+        const size_t first = instances.size();
+        instances.resize(first + count);
+        return instances.data() + first;
+    }
+
+    // upload all queued instances and issue one draw per group (or per quad if batching is off)
+    void flush() {
+        const auto start = std::chrono::steady_clock::now();
+        stats = BatchStats{};
+        removeIdleGroups();
+
+        size_t total = 0;
+        for (const Group &group : groups) {
+            total += group.instances.size();
+        }
+        if (total == 0) {
+            return;
+        }
+
+        // write every instance straight into this frame's region of the stream buffer
+        const size_t bytes = total * sizeof(QuadInstance);
+        if (bytes > instanceBuffer.getRegionSize()) {
+            instanceBuffer.reserve(bytes + bytes / 2);
+        }
+        instanceBuffer.beginFrame();
+        size_t baseOffset = 0;
+        auto* mapped = static_cast<unsigned char*>(instanceBuffer.map(bytes, baseOffset, sizeof(QuadInstance)));
+        if (mapped == nullptr) {
+            // mapping failed, drop this frame's quads rather than drawing garbage
+            for (Group &group : groups) {
+                group.instances.clear();
+            }
+            instanceBuffer.endFrame();
+            return;
+        }
+        size_t written = 0;
+        for (const Group &group : groups) {
+            if (!group.instances.empty()) {
+                std::memcpy(mapped + written, group.instances.data(), group.instances.size() * sizeof(QuadInstance));
+                written += group.instances.size() * sizeof(QuadInstance);
+            }
+        }
+        instanceBuffer.unmap();
+
+        // one command per group, or per quad without batching, keyed by the state it needs
+        queue.clear();
+        draws.clear();
+        uint32_t first = 0;
+        for (size_t g = 0; g < groups.size(); g++) {
+            Group &group = groups[g];
+            if (group.instances.empty()) {
+                continue;
+            }
+            const auto count = static_cast<uint32_t>(group.instances.size());
+            if (batching) {
+                // a group is a single draw, it goes where its farthest quad would
+                float depth = -1.0f;
+                for (const QuadInstance &instance : group.instances) {
+                    depth = std::max(depth, instance.offset[2]);
+                }
+                queue.push(RenderQueue::makeKey(group.program, group.texture, group.VAO, depth),
+                           static_cast<uint32_t>(draws.size()));
+                draws.push_back(DrawRange{static_cast<uint32_t>(g), first, count});
+            } else {
+                // the old way: a draw for every single quad
+                for (uint32_t i = 0; i < count; i++) {
+                    queue.push(RenderQueue::makeKey(group.program, group.texture, group.VAO, group.instances[i].offset[2]),
+                               static_cast<uint32_t>(draws.size()));
+                    draws.push_back(DrawRange{static_cast<uint32_t>(g), first + i, 1});
+                }
+            }
+            stats.groups++;
+            stats.instances += count;
+            first += count;
+            group.instances.clear(); // keeps capacity for the next frame
+        }
+        if (sorting) {
+            const auto sortStart = std::chrono::steady_clock::now();
+            queue.sort();
+            stats.sortPasses = queue.getLastPasses();
+            stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sortStart).count();
+        }
+
+        // the stream buffer, texture uploads and mesh creation bind things between flushes
+        state.invalidate();
+        state.resetCounters();
+        pointedVAOs.clear(); // the buffer region moved, and so may have the attributes
+        for (const RenderCommand &command : queue.getCommands()) {
+            const DrawRange &draw = draws[command.index];
+            const Group &group = groups[draw.group];
+            stats.programBinds += state.useProgram(group.program) ? 1 : 0;
+            stats.textureBinds += state.bindTexture(group.texture) ? 1 : 0;
+            stats.vaoBinds += state.bindVertexArray(group.VAO) ? 1 : 0;
+            if (baseInstance) {
+                bindInstanceAttributes(group.VAO, baseOffset);
+                glDrawElementsInstancedBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(group.indexCount),
+                                                    group.indexType, nullptr, static_cast<GLsizei>(draw.count),
+                                                    draw.first);
+            } else {
+                bindInstanceAttributes(group.VAO, baseOffset + draw.first * sizeof(QuadInstance));
+                glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(group.indexCount), group.indexType,
+                                        nullptr, static_cast<GLsizei>(draw.count));
+            }
+            state.countIssued();
+            stats.drawCalls++;
+        }
+        // the VAO stays bound, everything that binds its own buffers binds its own VAO first
+        stats.calls = state.getCalls();
+        instanceBuffer.endFrame();
+
+        stats.submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    [[nodiscard]] const BatchStats &getStats() const {
+        return stats;
+    }
+};
+
+#endif //LEARNOPENGL_BATCH_RENDERER_H
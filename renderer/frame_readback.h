@@ -0,0 +1,170 @@
+#ifndef LEARNOPENGL_FRAME_READBACK_H
+#define LEARNOPENGL_FRAME_READBACK_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <utility>
+#include <vector>
+
+// an RGBA8 frame read back from the GPU, rows are top to bottom like an image file
+struct CapturedFrame {
+    uint64_t frame = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+};
+
+struct FrameReadbackStats {
+    unsigned int captures = 0;
+    unsigned int completed = 0;
+    unsigned int stalls = 0; // captures that had to wait because every PBO was still in flight
+    double waitMs = 0.0;
+    double copyMs = 0.0;     // mapping the PBOs and flipping rows on the CPU
+};
+
+// Reads frames back through a small ring of pixel pack buffers.
+// capture() only queues the copy, the pixels are picked up a few frames
+// later with poll() once the fence says the GPU is done, so a readback
+// doesn't drain the pipeline like a plain glReadPixels would.
+class FrameReadback {
+private:
+    struct Slot {
+        unsigned int buffer = 0;
+        GLsync fence = nullptr;
+        uint64_t frame = 0;
+    };
+
+    int width;
+    int height;
+    std::vector<Slot> slots;
+    size_t next = 0;      // slot the next capture goes into
+    size_t pending = 0;   // captures issued but not collected yet
+    std::deque<CapturedFrame> finished;
+    FrameReadbackStats stats;
+
+    [[nodiscard]] size_t frameBytes() const {
+        return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+    }
+
+    // the oldest in flight capture
+    Slot &oldest() {
+        return slots[(next + slots.size() - pending) % slots.size()];
+    }
+
+    void collect(Slot &slot) {
+        const auto start = std::chrono::steady_clock::now();
+        CapturedFrame frame;
+        frame.frame = slot.frame;
+        frame.width = width;
+        frame.height = height;
+        frame.pixels.resize(frameBytes());
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        const auto* mapped = static_cast<const unsigned char*>(
+                glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(frameBytes()), GL_MAP_READ_BIT));
+        if (mapped != nullptr) {
+            // GL rows start at the bottom
+            const size_t rowBytes = static_cast<size_t>(width) * 4;
+            for (int y = 0; y < height; y++) {
+                std::memcpy(frame.pixels.data() + static_cast<size_t>(height - 1 - y) * rowBytes,
+                            mapped + static_cast<size_t>(y) * rowBytes, rowBytes);
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        pending--;
+        stats.completed++;
+        stats.copyMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        finished.push_back(std::move(frame));
+    }
+
+    void waitFor(Slot &slot) {
+        const auto start = std::chrono::steady_clock::now();
+        while (glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {
+        }
+        stats.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    // slots is how many captures can be in flight before capture() has to wait
+    FrameReadback(int width, int height, int slotCount = 3)
+        : width(width), height(height), slots(static_cast<size_t>(slotCount < 1 ? 1 : slotCount)) {
+        for (Slot &slot : slots) {
+            glGenBuffers(1, &slot.buffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(frameBytes()), nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    ~FrameReadback() {
+        for (Slot &slot : slots) {
+            if (slot.fence) {
+                glDeleteSync(slot.fence);
+            }
+            glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+
+    FrameReadback(const FrameReadback&) = delete;
+    FrameReadback& operator=(const FrameReadback&) = delete;
+
+    // queues a copy of the bound read framebuffer, call after the frame's draws
+    void capture(uint64_t frame) {
+        if (pending == slots.size()) {
+            stats.stalls++;
+            Slot &slot = oldest();
+            waitFor(slot);
+            collect(slot);
+        }
+        Slot &slot = slots[next];
+        slot.frame = frame;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        next = (next + 1) % slots.size();
+        pending++;
+        stats.captures++;
+    }
+
+    // hands out the oldest finished capture without waiting, false if none is ready yet
+    bool poll(CapturedFrame &out) {
+        while (pending > 0) {
+            Slot &slot = oldest();
+            if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+                break;
+            }
+            collect(slot);
+        }
+        if (finished.empty()) {
+            return false;
+        }
+        out = std::move(finished.front());
+        finished.pop_front();
+        return true;
+    }
+
+    // like poll() but waits for the GPU, use at shutdown to drain every capture
+    bool wait(CapturedFrame &out) {
+        if (finished.empty() && pending > 0) {
+            Slot &slot = oldest();
+            waitFor(slot);
+            collect(slot);
+        }
+        return poll(out);
+    }
+
+    [[nodiscard]] const FrameReadbackStats &getStats() const {
+        return stats;
+    }
+};
+
+#endif //LEARNOPENGL_FRAME_READBACK_H
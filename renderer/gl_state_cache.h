@@ -0,0 +1,128 @@
+#ifndef LEARNOPENGL_GL_STATE_CACHE_H
+#define LEARNOPENGL_GL_STATE_CACHE_H
+
+#include <glad/glad.h>
+#include <ostream>
+
+// GL calls made through a GLStateCache since its counters were last reset
+struct GLCallStats {
+    unsigned int issued = 0; // calls that reached the driver, binds as well as draws and attribute setup
+    unsigned int elided = 0; // binds skipped because the object was already bound
+};
+
+inline std::ostream &operator<<(std::ostream &out, const GLCallStats &stats) {
+    out << "gl calls: " << stats.issued << " issued, " << stats.elided << " elided";
+    return out;
+}
+
+// Remembers the bound program, 2D texture, VAO and buffers and drops binds that
+// wouldn't change anything. Code that binds behind its back (texture uploads,
+// mesh creation, Shader::use) must be followed by invalidate(), after which the
+// next bind of each kind always goes through. Only texture unit 0 is tracked,
+// nothing in the renderer switches the active unit.
+class GLStateCache {
+private:
+    static constexpr unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+    unsigned int program = UNKNOWN;
+    unsigned int texture = UNKNOWN;
+    unsigned int VAO = UNKNOWN;
+    unsigned int arrayBuffer = UNKNOWN;
+    unsigned int elementBuffer = UNKNOWN; // part of the VAO's state
+    bool enabled = true;
+    GLCallStats calls;
+
+    // true if the bind has to be issued, updates the cached name
+    bool change(unsigned int &current, unsigned int name) {
+        if (enabled && current == name) {
+            calls.elided++;
+            return false;
+        }
+        current = name;
+        calls.issued++;
+        return true;
+    }
+
+public:
+    GLStateCache() = default;
+
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    // when disabled every bind is issued, handy for A/B measurements
+    void setEnabled(bool value) {
+        enabled = value;
+        invalidate();
+    }
+
+    [[nodiscard]] bool isEnabled() const {
+        return enabled;
+    }
+
+    // forget everything, the GL state may have been changed elsewhere
+    void invalidate() {
+        program = UNKNOWN;
+        texture = UNKNOWN;
+        VAO = UNKNOWN;
+        arrayBuffer = UNKNOWN;
+        elementBuffer = UNKNOWN;
+    }
+
+    // returns true if the bind was issued
+    bool useProgram(unsigned int name) {
+        if (!change(program, name)) {
+            return false;
+        }
+        glUseProgram(name);
+        return true;
+    }
+
+    bool bindTexture(unsigned int name) {
+        if (!change(texture, name)) {
+            return false;
+        }
+        glBindTexture(GL_TEXTURE_2D, name);
+        return true;
+    }
+
+    bool bindVertexArray(unsigned int name) {
+        if (!change(VAO, name)) {
+            return false;
+        }
+        glBindVertexArray(name);
+        // every VAO carries its own element buffer binding
+        elementBuffer = UNKNOWN;
+        return true;
+    }
+
+    // only GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are tracked, other targets are always bound
+    bool bindBuffer(GLenum target, unsigned int name) {
+        bool issue = true;
+        if (target == GL_ARRAY_BUFFER) {
+            issue = change(arrayBuffer, name);
+        } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+            issue = change(elementBuffer, name);
+        } else {
+            calls.issued++;
+        }
+        if (issue) {
+            glBindBuffer(target, name);
+        }
+        return issue;
+    }
+
+    // calls the cache has nothing to filter, e.g. draws, so issued counts everything sent to the driver
+    void countIssued(unsigned int count = 1) {
+        calls.issued += count;
+    }
+
+    void resetCounters() {
+        calls = GLCallStats{};
+    }
+
+    [[nodiscard]] const GLCallStats &getCalls() const {
+        return calls;
+    }
+};
+
+#endif //LEARNOPENGL_GL_STATE_CACHE_H
@@ -0,0 +1,64 @@
+#ifndef LEARNOPENGL_OFFSCREEN_TARGET_H
+#define LEARNOPENGL_OFFSCREEN_TARGET_H
+
+#include <glad/glad.h>
+#include <iostream>
+
+// Framebuffer object with an RGBA8 color and a depth/stencil renderbuffer,
+// stands in for the default framebuffer when rendering headless.
+class OffscreenTarget {
+private:
+    unsigned int framebuffer = 0;
+    unsigned int color = 0;
+    unsigned int depthStencil = 0;
+    int width;
+    int height;
+
+public:
+    OffscreenTarget(int width, int height) : width(width), height(height) {
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(1, &color);
+        glGenRenderbuffers(1, &depthStencil);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthStencil);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencil);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "Offscreen framebuffer is incomplete" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    ~OffscreenTarget() {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &color);
+        glDeleteRenderbuffers(1, &depthStencil);
+    }
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    // draws and reads (glReadPixels) go to this target until another framebuffer is bound
+    void bind() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, width, height);
+    }
+
+    [[nodiscard]] unsigned int getFramebuffer() const {
+        return framebuffer;
+    }
+    [[nodiscard]] int getWidth() const {
+        return width;
+    }
+    [[nodiscard]] int getHeight() const {
+        return height;
+    }
+};
+
+#endif //LEARNOPENGL_OFFSCREEN_TARGET_H
@@ -0,0 +1,120 @@
+#ifndef LEARNOPENGL_RENDER_QUEUE_H
+#define LEARNOPENGL_RENDER_QUEUE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// one draw waiting to be submitted, index points into the caller's own draw data
+struct RenderCommand {
+    uint64_t key;
+    uint32_t index;
+};
+
+// Draw commands for a frame, sorted by a 64-bit key so draws sharing a program,
+// then a texture, then a VAO end up next to each other and the state cache can
+// drop the binds between them. Most to least significant:
+//   program (10 bits) | texture (16 bits) | VAO (14 bits) | depth (24 bits)
+// GL names that don't fit their field wrap around, which only costs some sorting
+// quality: the command still draws with its own state. Equal keys keep the order
+// they were pushed in, so a frame always comes out the same.
+class RenderQueue {
+private:
+    static constexpr unsigned int PROGRAM_BITS = 10;
+    static constexpr unsigned int TEXTURE_BITS = 16;
+    static constexpr unsigned int VAO_BITS = 14;
+    static constexpr unsigned int DEPTH_BITS = 24;
+    static_assert(PROGRAM_BITS + TEXTURE_BITS + VAO_BITS + DEPTH_BITS == 64, "sort key fields must fill 64 bits");
+    static constexpr unsigned int RADIX_BITS = 8;
+    static constexpr unsigned int RADIX_PASSES = 64 / RADIX_BITS;
+    static constexpr size_t BUCKETS = size_t{1} << RADIX_BITS;
+
+    std::vector<RenderCommand> commands;
+    std::vector<RenderCommand> scratch;
+    std::vector<uint32_t> counts; // one histogram per pass
+    unsigned int lastPasses = 0;
+
+    static uint64_t field(unsigned int value, unsigned int bits) {
+        return static_cast<uint64_t>(value) & ((uint64_t{1} << bits) - 1);
+    }
+
+public:
+    RenderQueue() = default;
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // depth is the NDC z in [-1, 1], draws with the same state go back to front
+    // since nothing is depth tested and later draws cover earlier ones
+    static uint64_t makeKey(unsigned int program, unsigned int texture, unsigned int VAO, float depth) {
+        // 1 at the near plane (z = -1), 0 at the far plane, so ascending keys put far draws first
+        const float nearness = std::clamp((1.0f - depth) * 0.5f, 0.0f, 1.0f);
+        const auto depthBits = static_cast<unsigned int>(std::lround(nearness * static_cast<float>((1u << DEPTH_BITS) - 1)));
+        return (field(program, PROGRAM_BITS) << (TEXTURE_BITS + VAO_BITS + DEPTH_BITS)) |
+               (field(texture, TEXTURE_BITS) << (VAO_BITS + DEPTH_BITS)) |
+               (field(VAO, VAO_BITS) << DEPTH_BITS) |
+               field(depthBits, DEPTH_BITS);
+    }
+
+    void push(uint64_t key, uint32_t index) {
+        commands.push_back(RenderCommand{key, index});
+    }
+
+    // least significant digit radix sort, 8 bits per pass. All histograms come out of
+    // one read over the keys, and a pass whose digit is the same for every key is skipped,
+    // which with few programs and textures is most of them
+    void sort() {
+        lastPasses = 0;
+        const size_t count = commands.size();
+        if (count < 2) {
+            return;
+        }
+        counts.assign(RADIX_PASSES * BUCKETS, 0);
+        for (const RenderCommand &command : commands) {
+            for (unsigned int pass = 0; pass < RADIX_PASSES; pass++) {
+                counts[pass * BUCKETS + ((command.key >> (pass * RADIX_BITS)) & (BUCKETS - 1))]++;
+            }
+        }
+        scratch.resize(count);
+        for (unsigned int pass = 0; pass < RADIX_PASSES; pass++) {
+            const unsigned int shift = pass * RADIX_BITS;
+            uint32_t* histogram = counts.data() + pass * BUCKETS;
+            if (histogram[(commands[0].key >> shift) & (BUCKETS - 1)] == count) {
+                continue;
+            }
+            // bucket sizes become the index each bucket starts at
+            uint32_t offset = 0;
+            for (size_t bucket = 0; bucket < BUCKETS; bucket++) {
+                const uint32_t size = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += size;
+            }
+            for (const RenderCommand &command : commands) {
+                scratch[histogram[(command.key >> shift) & (BUCKETS - 1)]++] = command;
+            }
+            commands.swap(scratch);
+            lastPasses++;
+        }
+    }
+
+    void clear() {
+        commands.clear(); // keeps capacity for the next frame
+    }
+
+    [[nodiscard]] const std::vector<RenderCommand> &getCommands() const {
+        return commands;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return commands.size();
+    }
+
+    // scatter passes the last sort() needed, at most 8
+    [[nodiscard]] unsigned int getLastPasses() const {
+        return lastPasses;
+    }
+};
+
+#endif //LEARNOPENGL_RENDER_QUEUE_H
@@ -0,0 +1,215 @@
+#ifndef LEARNOPENGL_STREAM_BUFFER_H
+#define LEARNOPENGL_STREAM_BUFFER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+struct StreamBufferStats {
+    size_t bytesThisFrame = 0;
+    unsigned int allocationsThisFrame = 0;
+    unsigned int overflows = 0; // map() calls that didn't fit in the frame's region
+    unsigned int stalls = 0;    // beginFrame() calls that had to wait for the GPU
+    double waitMs = 0.0;        // total time spent waiting on fences
+};
+
+// Ring buffer for per-frame CPU generated vertex or index data.
+// The buffer is split into one region per frame in flight. Each frame writes
+// only into its own region and fences it in endFrame(), so the CPU never
+// touches memory the GPU may still be reading.
+// With GL 4.4 / ARB_buffer_storage the whole buffer stays persistently and
+// coherently mapped, otherwise every map() is an unsynchronized glMapBufferRange.
+// The extension path needs loadBufferStorageExtension() after loading glad.
+class StreamBuffer {
+private:
+    static constexpr int MAX_REGIONS = 4;
+
+    GLenum target;
+    unsigned int buffer = 0;
+    size_t regionSize = 0;
+    int regionCount;
+    int region = 0;
+    size_t head = 0; // write position inside the current region
+    bool persistent = false;
+    bool mapped = false; // fallback path: a range is currently mapped
+    unsigned char* base = nullptr; // persistent mapping of the whole buffer
+    GLsync fences[MAX_REGIONS] = {};
+    StreamBufferStats stats;
+
+    static bool extensionSupported(const char* extension) {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++) {
+            const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<unsigned int>(i)));
+            if (name && std::strcmp(name, extension) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void create() {
+        const auto size = static_cast<GLsizeiptr>(regionSize * static_cast<size_t>(regionCount));
+        glGenBuffers(1, &buffer);
+        glBindBuffer(target, buffer);
+        if (persistent) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(target, size, nullptr, flags);
+            base = static_cast<unsigned char*>(glMapBufferRange(target, 0, size, flags));
+            if (base == nullptr) {
+                // storage is immutable, start over with a plain buffer
+                glDeleteBuffers(1, &buffer);
+                persistent = false;
+                create();
+                return;
+            }
+        } else {
+            glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    void destroy() {
+        for (GLsync &fence : fences) {
+            if (fence) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+        if (buffer != 0) {
+            glBindBuffer(target, buffer);
+            if (base != nullptr || mapped) {
+                glUnmapBuffer(target);
+            }
+            glDeleteBuffers(1, &buffer);
+        }
+        buffer = 0;
+        base = nullptr;
+        mapped = false;
+    }
+
+    void waitForRegion(int index) {
+        GLsync &fence = fences[index];
+        if (!fence) {
+            return;
+        }
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        if (result == GL_TIMEOUT_EXPIRED) {
+            const auto start = std::chrono::steady_clock::now();
+            stats.stalls++;
+            do {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+            } while (result == GL_TIMEOUT_EXPIRED);
+            stats.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+public:
+    // regionSize is the most a single frame may write, regions is the number of frames in flight
+    StreamBuffer(GLenum target, size_t regionSize, int regions = 3)
+        : target(target), regionSize(regionSize), regionCount(regions < 1 ? 1 : (regions > MAX_REGIONS ? MAX_REGIONS : regions)) {
+        persistent = GLAD_GL_VERSION_4_4 != 0 ||
+                     (glBufferStorage != nullptr && extensionSupported("GL_ARB_buffer_storage"));
+        create();
+    }
+
+    ~StreamBuffer() {
+        destroy();
+    }
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // moves on to the next region, waiting only if the GPU is still reading it
+    void beginFrame() {
+        region = (region + 1) % regionCount;
+        head = 0;
+        waitForRegion(region);
+        stats.bytesThisFrame = 0;
+        stats.allocationsThisFrame = 0;
+    }
+
+    // fences everything written this frame, call after the draws that use it
+    void endFrame() {
+        if (mapped) {
+            unmap();
+        }
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    // reserves size bytes in this frame's region and returns where to write them, or nullptr
+    // if the region is full. offset receives the byte offset to use in attribute pointers/draws.
+    void* map(size_t size, size_t &offset, size_t alignment = 16) {
+        const size_t aligned = (head + alignment - 1) / alignment * alignment;
+        if (aligned + size > regionSize) {
+            stats.overflows++;
+            return nullptr;
+        }
+        head = aligned + size;
+        offset = static_cast<size_t>(region) * regionSize + aligned;
+        stats.bytesThisFrame += size;
+        stats.allocationsThisFrame++;
+        if (persistent) {
+            return base + offset;
+        }
+        if (mapped) {
+            unmap();
+        }
+        glBindBuffer(target, buffer);
+        // the fence already guarantees the GPU is done with this range
+        void* pointer = glMapBufferRange(target, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size),
+                                         GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        mapped = pointer != nullptr;
+        return pointer;
+    }
+
+    // finishes the last map(), a no-op for persistent mappings
+    void unmap() {
+        if (mapped) {
+            glBindBuffer(target, buffer);
+            glUnmapBuffer(target);
+            mapped = false;
+        }
+    }
+
+    // grows the regions, waits for the GPU to finish with the old buffer first
+    void reserve(size_t newRegionSize) {
+        if (newRegionSize <= regionSize) {
+            return;
+        }
+        for (int i = 0; i < regionCount; i++) {
+            waitForRegion(i);
+        }
+        destroy();
+        regionSize = newRegionSize;
+        head = 0;
+        create();
+    }
+
+    [[nodiscard]] unsigned int getBuffer() const {
+        return buffer;
+    }
+    [[nodiscard]] size_t getRegionSize() const {
+        return regionSize;
+    }
+    [[nodiscard]] bool isPersistent() const {
+        return persistent;
+    }
+    [[nodiscard]] const StreamBufferStats &getStats() const {
+        return stats;
+    }
+};
+
+// glad was generated without extensions, so before GL 4.4 it leaves glBufferStorage unloaded even
+// when the context has ARB_buffer_storage, which uses the same entry point. Call right after
+// gladLoadGLLoader with the same loader, StreamBuffer only uses it if the extension is listed
+inline void loadBufferStorageExtension(GLADloadproc loader) {
+    if (!GLAD_GL_VERSION_4_4 && glad_glBufferStorage == nullptr) {
+        glad_glBufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(loader("glBufferStorage"));
+    }
+}
+
+#endif //LEARNOPENGL_STREAM_BUFFER_H
@@ -0,0 +1,172 @@
+#ifndef LEARNOPENGL_BLOCK_COMPRESSION_H
+#define LEARNOPENGL_BLOCK_COMPRESSION_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// CPU encoders for the S3TC block formats (BC1 = DXT1, BC3 = DXT5).
+// Every 4x4 pixel block becomes 8 bytes (BC1) or 16 bytes (BC3) holding two
+// RGB565 endpoints and a 2 bit index per pixel picking one of four colors on
+// the line between them; BC3 adds a separate alpha block in front.
+// Endpoints are the block's color bounding box pulled in by 1/16 of its size,
+// which is fast and close to what slower least-squares encoders manage on
+// photos and typical game textures.
+
+enum class BlockFormat {
+    BC1, // opaque RGB, 4 bits per pixel
+    BC3  // RGBA with smooth alpha, 8 bits per pixel
+};
+
+[[nodiscard]] inline size_t blockBytes(BlockFormat format) {
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+// size of a compressed width x height image, partial blocks at the edges are padded
+[[nodiscard]] inline size_t compressedSize(BlockFormat format, int width, int height) {
+    const auto blocksX = static_cast<size_t>((width + 3) / 4);
+    const auto blocksY = static_cast<size_t>((height + 3) / 4);
+    return blocksX * blocksY * blockBytes(format);
+}
+
+inline uint16_t packRGB565(int r, int g, int b) {
+    return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+// back to 8 bits per channel the way the hardware decodes it
+inline void unpackRGB565(uint16_t color, int rgb[3]) {
+    const int r = (color >> 11) & 0x1F;
+    const int g = (color >> 5) & 0x3F;
+    const int b = color & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+inline void writeLittleEndian(unsigned char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+// 8 byte color block, always in four color mode so it also works as the color half of BC3
+inline void encodeColorBlock(const unsigned char block[64], unsigned char* out) {
+    int minColor[3] = {255, 255, 255};
+    int maxColor[3] = {0, 0, 0};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            minColor[c] = std::min(minColor[c], static_cast<int>(block[i * 4 + c]));
+            maxColor[c] = std::max(maxColor[c], static_cast<int>(block[i * 4 + c]));
+        }
+    }
+    for (int c = 0; c < 3; c++) {
+        const int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] = std::min(255, minColor[c] + inset);
+        maxColor[c] = std::max(0, maxColor[c] - inset);
+    }
+
+    uint16_t color0 = packRGB565(maxColor[0], maxColor[1], maxColor[2]);
+    uint16_t color1 = packRGB565(minColor[0], minColor[1], minColor[2]);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        // four color mode needs color0 > color1, palette is c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+        int palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++) {
+            int best = 0;
+            int bestDistance = 0x7FFFFFFF;
+            for (int p = 0; p < 4; p++) {
+                int distance = 0;
+                for (int c = 0; c < 3; c++) {
+                    const int d = static_cast<int>(block[i * 4 + c]) - palette[p][c];
+                    distance += d * d;
+                }
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+        }
+    }
+    // a flat block keeps every index at 0, which is color0
+    writeLittleEndian(out, color0, 2);
+    writeLittleEndian(out + 2, color1, 2);
+    writeLittleEndian(out + 4, indices, 4);
+}
+
+// 8 byte alpha block in eight value mode: a0 > a1 and six values interpolated between them
+inline void encodeAlphaBlock(const unsigned char block[64], unsigned char* out) {
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    for (int i = 0; i < 16; i++) {
+        minAlpha = std::min(minAlpha, static_cast<int>(block[i * 4 + 3]));
+        maxAlpha = std::max(maxAlpha, static_cast<int>(block[i * 4 + 3]));
+    }
+    uint64_t indices = 0;
+    if (maxAlpha != minAlpha) {
+        int palette[8];
+        palette[0] = maxAlpha;
+        palette[1] = minAlpha;
+        for (int p = 1; p < 7; p++) {
+            palette[p + 1] = ((7 - p) * maxAlpha + p * minAlpha) / 7;
+        }
+        for (int i = 0; i < 16; i++) {
+            const int alpha = block[i * 4 + 3];
+            int best = 0;
+            int bestDistance = 256;
+            for (int p = 0; p < 8; p++) {
+                const int distance = std::abs(alpha - palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= static_cast<uint64_t>(best) << (3 * i);
+        }
+    }
+    out[0] = static_cast<unsigned char>(maxAlpha);
+    out[1] = static_cast<unsigned char>(minAlpha);
+    writeLittleEndian(out + 2, indices, 6);
+}
+
+// Compresses a tightly packed RGBA8 image, rows in the same order they will be
+// uploaded in. Returns compressedSize(format, width, height) bytes.
+inline std::vector<unsigned char> compressImage(BlockFormat format, const unsigned char* pixels, int width, int height) {
+    std::vector<unsigned char> out(compressedSize(format, width, height));
+    unsigned char* cursor = out.data();
+    unsigned char block[64];
+    for (int blockY = 0; blockY < height; blockY += 4) {
+        for (int blockX = 0; blockX < width; blockX += 4) {
+            // blocks hanging over the edge repeat the last row/column
+            for (int y = 0; y < 4; y++) {
+                const int sy = std::min(blockY + y, height - 1);
+                for (int x = 0; x < 4; x++) {
+                    const int sx = std::min(blockX + x, width - 1);
+                    std::memcpy(block + (y * 4 + x) * 4,
+                                pixels + (static_cast<size_t>(sy) * static_cast<size_t>(width) + static_cast<size_t>(sx)) * 4, 4);
+                }
+            }
+            if (format == BlockFormat::BC3) {
+                encodeAlphaBlock(block, cursor);
+                cursor += 8;
+            }
+            encodeColorBlock(block, cursor);
+            cursor += 8;
+        }
+    }
+    return out;
+}
+
+#endif //LEARNOPENGL_BLOCK_COMPRESSION_H
@@ -0,0 +1,207 @@
+#ifndef LEARNOPENGL_FILE_WATCHER_H
+#define LEARNOPENGL_FILE_WATCHER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Calls onChange on its own thread whenever one of the watched files has been written.
+// On Linux it sleeps on inotify, watching the files' directories rather than the files
+// so editors that save into a temp file and rename it over the original are seen too.
+// Elsewhere, if inotify is unavailable, or for files whose directory it can't watch,
+// the modification times are polled instead, which can report a file that is still
+// being written: the next write reports it again.
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::string &path)>;
+
+private:
+    static constexpr int WAKE_MS = 100; // how often the idle thread checks whether it should exit
+    static constexpr int POLL_MS = 250;
+
+    struct WatchedFile {
+        std::string path;
+        std::filesystem::file_time_type writeTime;
+        bool polled; // inotify can't watch its directory
+    };
+
+    Callback onChange;
+    std::mutex mutex;
+    std::vector<WatchedFile> files; // guarded by mutex
+    std::atomic<bool> stopping{false};
+    int inotify = -1;
+    std::unordered_map<int, std::string> directories; // inotify watch descriptor -> directory, guarded by mutex
+    std::thread thread;
+
+    static std::filesystem::file_time_type writeTimeOf(const std::string &path) {
+        std::error_code error;
+        const auto time = std::filesystem::last_write_time(path, error);
+        return error ? std::filesystem::file_time_type::min() : time;
+    }
+
+    bool isWatched(const std::string &path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const WatchedFile &file : files) {
+            if (file.path == path) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // an editor can write a file several times per save, report it once per wakeup
+    void notify(std::vector<std::string> &changed) {
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        for (const std::string &path : changed) {
+            onChange(path);
+        }
+        changed.clear();
+    }
+
+    // onlyPolled skips the files inotify already reports
+    void pollWriteTimes(std::vector<std::string> &changed, bool onlyPolled) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (WatchedFile &file : files) {
+            if (onlyPolled && !file.polled) {
+                continue;
+            }
+            const auto time = writeTimeOf(file.path);
+            if (time != file.writeTime && time != std::filesystem::file_time_type::min()) {
+                file.writeTime = time;
+                changed.push_back(file.path);
+            }
+        }
+    }
+
+#ifdef __linux__
+    void readEvents(std::vector<std::string> &changed) {
+        alignas(inotify_event) char buffer[4096];
+        ssize_t length;
+        while ((length = read(inotify, buffer, sizeof(buffer))) > 0) {
+            for (char* cursor = buffer; cursor < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                cursor += sizeof(inotify_event) + event->len;
+                if (event->len == 0 || !(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))) {
+                    continue;
+                }
+                std::string directory;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    const auto it = directories.find(event->wd);
+                    if (it == directories.end()) {
+                        continue;
+                    }
+                    directory = it->second;
+                }
+                const std::string path = (std::filesystem::path(directory) / event->name).string();
+                if (isWatched(path)) {
+                    changed.push_back(path);
+                }
+            }
+        }
+    }
+#endif
+
+    void run() {
+        std::vector<std::string> changed;
+        auto lastPoll = std::chrono::steady_clock::now();
+        while (!stopping) {
+#ifdef __linux__
+            if (inotify >= 0) {
+                pollfd descriptor{inotify, POLLIN, 0};
+                if (poll(&descriptor, 1, WAKE_MS) > 0) {
+                    readEvents(changed);
+                }
+                if (std::chrono::steady_clock::now() - lastPoll >= std::chrono::milliseconds(POLL_MS)) {
+                    lastPoll = std::chrono::steady_clock::now();
+                    pollWriteTimes(changed, true);
+                }
+                notify(changed);
+                continue;
+            }
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(WAKE_MS));
+            if (std::chrono::steady_clock::now() - lastPoll >= std::chrono::milliseconds(POLL_MS)) {
+                lastPoll = std::chrono::steady_clock::now();
+                pollWriteTimes(changed, false);
+                notify(changed);
+            }
+        }
+    }
+
+public:
+    explicit FileWatcher(Callback onChange) : onChange(std::move(onChange)) {
+#ifdef __linux__
+        inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify < 0) {
+            std::cout << "inotify unavailable, polling watched files instead" << std::endl;
+        }
+#endif
+        thread = std::thread(&FileWatcher::run, this);
+    }
+
+    ~FileWatcher() {
+        stopping = true;
+        thread.join();
+#ifdef __linux__
+        if (inotify >= 0) {
+            close(inotify);
+        }
+#endif
+    }
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // the form paths are reported in, so callers can compare them with the ones they asked for
+    static std::string canonicalPath(const std::string &path) {
+        std::error_code error;
+        const std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+        return error ? std::filesystem::absolute(path).lexically_normal().string() : canonical.string();
+    }
+
+    // starts reporting writes to path, watching the same file twice is fine
+    void watch(const std::string &path) {
+        const std::string canonical = canonicalPath(path);
+        if (isWatched(canonical)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        WatchedFile file{canonical, writeTimeOf(canonical), true};
+#ifdef __linux__
+        if (inotify >= 0) {
+            const std::string directory = std::filesystem::path(canonical).parent_path().string();
+            const int descriptor = inotify_add_watch(inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+            if (descriptor < 0) {
+                // e.g. out of watches or a filesystem without inotify support
+                std::cout << "Failed to watch " << directory << ", polling " << canonical << " instead" << std::endl;
+            } else {
+                directories[descriptor] = directory;
+                file.polled = false;
+            }
+        }
+#endif
+        files.push_back(file);
+    }
+
+    [[nodiscard]] bool isPolling() const {
+        return inotify < 0;
+    }
+};
+
+#endif //LEARNOPENGL_FILE_WATCHER_H
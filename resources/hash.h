@@ -0,0 +1,27 @@
+#ifndef LEARNOPENGL_HASH_H
+#define LEARNOPENGL_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 64-bit FNV-1a, good enough to tell shader sources and image files apart
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+inline uint64_t hashString(const std::string &text, uint64_t hash = 0xcbf29ce484222325ull) {
+    return hashBytes(text.data(), text.size(), hash);
+}
+
+// order dependent combination of two hashes
+inline uint64_t hashCombine(uint64_t a, uint64_t b) {
+    return a ^ (b + 0x9e3779b97f4a7c15ull + (a << 6) + (a >> 2));
+}
+
+#endif //LEARNOPENGL_HASH_H
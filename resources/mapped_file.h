@@ -0,0 +1,124 @@
+#ifndef LEARNOPENGL_MAPPED_FILE_H
+#define LEARNOPENGL_MAPPED_FILE_H
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only memory mapping of a whole file. Pages are only read from disk
+// (or the page cache) when they are touched, and nothing is copied into
+// the process until then.
+class MappedFile {
+private:
+    const unsigned char* mapped = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+
+public:
+    MappedFile() = default;
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // maps path for reading, sequential tells the OS to read ahead aggressively
+    bool open(const std::string &path, bool sequential = true) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            std::cout << "Failed to open " << path << std::endl;
+            close();
+            return false;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        mapped = mapping ? static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+        if (mapped == nullptr) {
+            std::cout << "Failed to map " << path << std::endl;
+            close();
+            return false;
+        }
+        length = static_cast<size_t>(size.QuadPart);
+#else
+        const int descriptor = ::open(path.c_str(), O_RDONLY);
+        struct stat info{};
+        if (descriptor < 0 || fstat(descriptor, &info) != 0 || info.st_size == 0) {
+            std::cout << "Failed to open " << path << std::endl;
+            if (descriptor >= 0) {
+                ::close(descriptor);
+            }
+            return false;
+        }
+        void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor); // the mapping keeps the file alive
+        if (address == MAP_FAILED) {
+            std::cout << "Failed to map " << path << std::endl;
+            return false;
+        }
+        if (sequential) {
+            madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+        }
+        mapped = static_cast<const unsigned char*>(address);
+        length = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (mapped != nullptr) {
+            UnmapViewOfFile(mapped);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (mapped != nullptr) {
+            munmap(const_cast<unsigned char*>(mapped), length);
+        }
+#endif
+        mapped = nullptr;
+        length = 0;
+    }
+
+    [[nodiscard]] const unsigned char* data() const {
+        return mapped;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return length;
+    }
+
+    [[nodiscard]] bool isOpen() const {
+        return mapped != nullptr;
+    }
+};
+
+#endif //LEARNOPENGL_MAPPED_FILE_H
@@ -0,0 +1,322 @@
+#ifndef LEARNOPENGL_MESH_FILE_H
+#define LEARNOPENGL_MESH_FILE_H
+
+#include <glad/glad.h>
+#include "structs/shapes.h"
+#include "structs/vertex_layout.h"
+#include "resources/mapped_file.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Binary mesh file (.lmesh), holding any number of named meshes.
+// Layout, little endian:
+//   MeshFileHeader
+//   MeshFileEntry for every mesh
+//   for every mesh its vertex block, then its index block
+// Blocks start on MESH_FILE_ALIGNMENT boundaries so they can be handed to GL
+// straight out of a memory mapping. Each entry declares the vertex layout its
+// block uses, the converter writes VertexLayout::quantized() vertices.
+constexpr char MESH_FILE_MAGIC[8] = {'L', 'O', 'G', 'L', 'M', 'S', 'H', '1'};
+constexpr uint64_t MESH_FILE_ALIGNMENT = 64;
+
+struct MeshFileHeader {
+    char magic[8];
+    uint32_t meshCount;
+    uint32_t reserved;
+    uint64_t fileSize;
+};
+static_assert(sizeof(MeshFileHeader) == 24, "MeshFileHeader is part of the file format");
+
+struct MeshFileAttribute {
+    uint32_t location;
+    uint32_t components;
+    uint32_t type; // GL_FLOAT, GL_HALF_FLOAT, GL_UNSIGNED_BYTE, ...
+    uint32_t normalized;
+    uint32_t offset;
+};
+
+struct MeshFileEntry {
+    char name[48]; // zero terminated
+    uint64_t vertexOffset;
+    uint64_t vertexBytes;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint32_t stride;
+    uint32_t attributeCount;
+    MeshFileAttribute attributes[VertexLayout::MAX_ATTRIBUTES];
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t reserved;
+};
+static_assert(sizeof(MeshFileEntry) == 288, "MeshFileEntry is part of the file format");
+
+// a mesh as the converter produces it, indices are stored as 16 bit whenever the vertex count allows
+struct MeshData {
+    std::string name;
+    VertexLayout layout;
+    std::vector<unsigned char> vertices;
+    std::vector<uint32_t> indices;
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+};
+
+// a mesh inside an open MeshFile, the pointers stay valid while the file is open
+struct MeshView {
+    std::string name;
+    VertexLayout layout;
+    unsigned int vertexCount = 0;
+    unsigned int indexCount = 0;
+    unsigned int indexType = GL_UNSIGNED_INT;
+    const unsigned char* vertices = nullptr;
+    size_t vertexBytes = 0;
+    const unsigned char* indices = nullptr;
+    size_t indexBytes = 0;
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+};
+
+inline uint64_t alignMeshBlock(uint64_t offset) {
+    return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+// Reads .lmesh files through a memory mapping. Nothing is copied on open():
+// only the header and entry table are touched, the vertex and index blocks are
+// read by the driver when upload() passes their mapped address to glBufferData.
+class MeshFile {
+private:
+    MappedFile file;
+    std::vector<MeshView> meshes;
+
+    // checks every size, offset and attribute location against the data so a truncated or corrupt
+    // file can't read outside the mapping. The indices themselves are checked by upload()
+    bool parse(const unsigned char* data, size_t size, const std::string &source) {
+        meshes.clear();
+        MeshFileHeader header{};
+        if (size < sizeof(header)) {
+            std::cout << "Mesh file " << source << " is too small" << std::endl;
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) != 0 || header.fileSize != size ||
+            (size - sizeof(header)) / sizeof(MeshFileEntry) < header.meshCount) {
+            std::cout << "Mesh file " << source << " has a bad header" << std::endl;
+            return false;
+        }
+        for (uint32_t i = 0; i < header.meshCount; i++) {
+            MeshFileEntry entry{};
+            std::memcpy(&entry, data + sizeof(header) + i * sizeof(MeshFileEntry), sizeof(entry));
+            const uint64_t indexSize = entry.indexType == GL_UNSIGNED_SHORT ? 2 : entry.indexType == GL_UNSIGNED_INT ? 4 : 0;
+            bool valid = indexSize != 0 && entry.attributeCount <= VertexLayout::MAX_ATTRIBUTES && entry.stride > 0 &&
+                         entry.vertexBytes == static_cast<uint64_t>(entry.vertexCount) * entry.stride &&
+                         entry.indexBytes == static_cast<uint64_t>(entry.indexCount) * indexSize &&
+                         entry.vertexOffset % MESH_FILE_ALIGNMENT == 0 && entry.indexOffset % MESH_FILE_ALIGNMENT == 0 &&
+                         entry.vertexOffset <= size && entry.vertexBytes <= size - entry.vertexOffset &&
+                         entry.indexOffset <= size && entry.indexBytes <= size - entry.indexOffset;
+
+            MeshView mesh;
+            entry.name[sizeof(entry.name) - 1] = '\0';
+            mesh.name = entry.name;
+            mesh.layout.stride = entry.stride;
+            for (uint32_t a = 0; valid && a < entry.attributeCount; a++) {
+                const MeshFileAttribute &attribute = entry.attributes[a];
+                const uint64_t end = attribute.offset + static_cast<uint64_t>(attribute.components) * vertexTypeSize(attribute.type);
+                valid = attribute.components >= 1 && attribute.components <= 4 && vertexTypeSize(attribute.type) != 0 &&
+                        end <= entry.stride && VertexLayout::isVertexLocation(attribute.location);
+                mesh.layout.attributes.push_back(VertexAttribute{attribute.location, static_cast<int>(attribute.components),
+                                                                 attribute.type, attribute.normalized != 0, attribute.offset});
+            }
+            if (!valid) {
+                std::cout << "Mesh file " << source << " has a bad entry for mesh " << i << std::endl;
+                meshes.clear();
+                return false;
+            }
+            mesh.vertexCount = entry.vertexCount;
+            mesh.indexCount = entry.indexCount;
+            mesh.indexType = entry.indexType;
+            mesh.vertices = data + entry.vertexOffset;
+            mesh.vertexBytes = entry.vertexBytes;
+            mesh.indices = data + entry.indexOffset;
+            mesh.indexBytes = entry.indexBytes;
+            std::memcpy(mesh.boundsMin, entry.boundsMin, sizeof(mesh.boundsMin));
+            std::memcpy(mesh.boundsMax, entry.boundsMax, sizeof(mesh.boundsMax));
+            meshes.push_back(std::move(mesh));
+        }
+        return true;
+    }
+
+    // one pass over the mapped indices, the only part of the mesh data upload() reads on the CPU
+    static bool indicesInRange(const MeshView &view) {
+        uint32_t largest = 0;
+        if (view.indexType == GL_UNSIGNED_SHORT) {
+            for (size_t i = 0; i < view.indexCount; i++) {
+                uint16_t value;
+                std::memcpy(&value, view.indices + i * sizeof(value), sizeof(value));
+                largest = std::max<uint32_t>(largest, value);
+            }
+        } else {
+            for (size_t i = 0; i < view.indexCount; i++) {
+                uint32_t value;
+                std::memcpy(&value, view.indices + i * sizeof(value), sizeof(value));
+                largest = std::max(largest, value);
+            }
+        }
+        return view.indexCount == 0 || largest < view.vertexCount;
+    }
+
+public:
+    MeshFile() = default;
+
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+
+    bool open(const std::string &path) {
+        return file.open(path) && parse(file.data(), file.size(), path);
+    }
+
+    // reads a file that's already in memory, data has to outlive the MeshFile
+    bool openMemory(const unsigned char* data, size_t size) {
+        file.close();
+        return parse(data, size, "in memory");
+    }
+
+    [[nodiscard]] size_t getMeshCount() const {
+        return meshes.size();
+    }
+
+    [[nodiscard]] const MeshView &getMesh(size_t index) const {
+        return meshes[index];
+    }
+
+    // index of the mesh called name, -1 if there is none
+    [[nodiscard]] int find(const std::string &name) const {
+        for (size_t i = 0; i < meshes.size(); i++) {
+            if (meshes[i].name == name) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    // creates the VAO and buffers, sourcing the data directly from the mapping and
+    // setting up the attributes from the mesh's declared layout. Returns null if an
+    // index points past the vertices, which a draw would otherwise read out of bounds
+    [[nodiscard]] std::shared_ptr<Mesh> upload(size_t index) const {
+        const MeshView &view = meshes[index];
+        if (!indicesInRange(view)) {
+            std::cout << "Mesh " << view.name << " has an index past its " << view.vertexCount << " vertices" << std::endl;
+            return nullptr;
+        }
+        auto mesh = std::make_shared<Mesh>();
+        mesh->indexCount = view.indexCount;
+        mesh->indexType = view.indexType;
+        mesh->bytes = view.vertexBytes + view.indexBytes;
+
+        glGenVertexArrays(1, &mesh->VAO);
+        glBindVertexArray(mesh->VAO);
+        glGenBuffers(1, &mesh->VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(view.vertexBytes), view.vertices, GL_STATIC_DRAW);
+        glGenBuffers(1, &mesh->EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(view.indexBytes), view.indices, GL_STATIC_DRAW);
+        view.layout.apply();
+        glBindVertexArray(0);
+        return mesh;
+    }
+};
+
+// writes meshes as an .lmesh file, through a temporary file so a crash never leaves a torn file behind
+inline bool writeMeshFile(const std::string &path, const std::vector<MeshData> &meshes) {
+    MeshFileHeader header{};
+    std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+
+    std::vector<MeshFileEntry> entries(meshes.size());
+    uint64_t offset = alignMeshBlock(sizeof(MeshFileHeader) + meshes.size() * sizeof(MeshFileEntry));
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const MeshData &mesh = meshes[i];
+        MeshFileEntry &entry = entries[i];
+        const bool locationsValid = std::all_of(mesh.layout.attributes.begin(), mesh.layout.attributes.end(),
+                                                [](const VertexAttribute &attribute) {
+                                                    return VertexLayout::isVertexLocation(attribute.location);
+                                                });
+        if (mesh.layout.stride == 0 || mesh.layout.attributes.size() > VertexLayout::MAX_ATTRIBUTES ||
+            mesh.vertices.size() % mesh.layout.stride != 0 || !locationsValid) {
+            std::cout << "Mesh " << mesh.name << " doesn't match its vertex layout" << std::endl;
+            return false;
+        }
+        std::strncpy(entry.name, mesh.name.c_str(), sizeof(entry.name) - 1);
+        entry.vertexCount = static_cast<uint32_t>(mesh.vertices.size() / mesh.layout.stride);
+        entry.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        entry.indexType = entry.vertexCount <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        entry.stride = mesh.layout.stride;
+        entry.attributeCount = static_cast<uint32_t>(mesh.layout.attributes.size());
+        for (size_t a = 0; a < mesh.layout.attributes.size(); a++) {
+            const VertexAttribute &attribute = mesh.layout.attributes[a];
+            entry.attributes[a] = MeshFileAttribute{attribute.location, static_cast<uint32_t>(attribute.components),
+                                                    attribute.type, attribute.normalized ? 1u : 0u, attribute.offset};
+        }
+        std::memcpy(entry.boundsMin, mesh.boundsMin, sizeof(entry.boundsMin));
+        std::memcpy(entry.boundsMax, mesh.boundsMax, sizeof(entry.boundsMax));
+        entry.vertexOffset = offset;
+        entry.vertexBytes = mesh.vertices.size();
+        entry.indexOffset = alignMeshBlock(offset + entry.vertexBytes);
+        entry.indexBytes = static_cast<uint64_t>(entry.indexCount) * (entry.indexType == GL_UNSIGNED_SHORT ? 2 : 4);
+        offset = alignMeshBlock(entry.indexOffset + entry.indexBytes);
+    }
+    header.fileSize = offset;
+
+    std::filesystem::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        const auto pad = [&file](uint64_t to) {
+            static const char zeros[MESH_FILE_ALIGNMENT] = {};
+            const auto position = static_cast<uint64_t>(file.tellp());
+            file.write(zeros, static_cast<std::streamsize>(to - position));
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()),
+                   static_cast<std::streamsize>(entries.size() * sizeof(MeshFileEntry)));
+        std::vector<uint16_t> shortIndices;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            pad(entries[i].vertexOffset);
+            file.write(reinterpret_cast<const char*>(meshes[i].vertices.data()),
+                       static_cast<std::streamsize>(meshes[i].vertices.size()));
+            pad(entries[i].indexOffset);
+            if (entries[i].indexType == GL_UNSIGNED_SHORT) {
+                shortIndices.assign(meshes[i].indices.begin(), meshes[i].indices.end());
+                file.write(reinterpret_cast<const char*>(shortIndices.data()),
+                           static_cast<std::streamsize>(shortIndices.size() * sizeof(uint16_t)));
+            } else {
+                file.write(reinterpret_cast<const char*>(meshes[i].indices.data()),
+                           static_cast<std::streamsize>(meshes[i].indices.size() * sizeof(uint32_t)));
+            }
+        }
+        pad(header.fileSize);
+        if (!file) {
+            std::cout << "Failed to write " << temporary << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::cout << "Failed to write " << path << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+#endif //LEARNOPENGL_MESH_FILE_H
@@ -0,0 +1,195 @@
+#ifndef LEARNOPENGL_PROGRAM_CACHE_H
+#define LEARNOPENGL_PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+#include "shaders.h"
+#include "resources/hash.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct ProgramCacheStats {
+    unsigned int hits = 0;     // programs restored with glProgramBinary
+    unsigned int misses = 0;   // programs compiled from source
+    unsigned int rejected = 0; // binaries the driver refused, e.g. after a driver update
+    unsigned int stored = 0;
+    double loadMs = 0.0;       // time spent restoring binaries
+    double compileMs = 0.0;    // time spent compiling, linking and storing
+};
+
+inline std::ostream &operator<<(std::ostream &out, const ProgramCacheStats &stats) {
+    out << "program cache: " << stats.hits << " hits (" << stats.loadMs << " ms), "
+        << stats.misses << " compiled (" << stats.compileMs << " ms), "
+        << stats.rejected << " rejected, " << stats.stored << " stored";
+    return out;
+}
+
+// On-disk cache of linked program binaries. Entries are keyed by the shader
+// sources plus the GL vendor/renderer/version strings, so a driver update
+// simply misses instead of loading an incompatible binary.
+class ProgramCache {
+private:
+    // file layout: header followed by the raw program binary
+    struct FileHeader {
+        char magic[8];
+        uint64_t driverHash;
+        uint32_t format;
+        uint32_t length;
+    };
+    static constexpr char MAGIC[8] = {'L', 'O', 'G', 'L', 'P', 'R', 'G', '1'};
+
+    std::filesystem::path directory;
+    uint64_t driverHash = 0;
+    bool supported = false;
+    ProgramCacheStats stats;
+
+    [[nodiscard]] std::filesystem::path entryPath(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return directory / name;
+    }
+
+    // returns a linked program, or 0 if there is no usable binary
+    unsigned int loadBinary(uint64_t key) {
+        const std::filesystem::path path = entryPath(key);
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            return 0;
+        }
+        std::error_code error;
+        const uint64_t fileSize = std::filesystem::file_size(path, error);
+        FileHeader header{};
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        // the binary is everything after the header, a length that disagrees means a torn or corrupt entry
+        if (error || !file || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.driverHash != driverHash || header.length == 0 || header.length != fileSize - sizeof(header)) {
+            file.close();
+            std::filesystem::remove(path, error);
+            return 0;
+        }
+        std::vector<char> binary(header.length);
+        file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+        if (!file) {
+            file.close();
+            std::filesystem::remove(path, error);
+            return 0;
+        }
+
+        const unsigned int program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            // the driver is free to reject binaries at any time, recompile and replace the entry
+            glDeleteProgram(program);
+            file.close();
+            std::filesystem::remove(path, error);
+            stats.rejected++;
+            return 0;
+        }
+        return program;
+    }
+
+    void storeBinary(uint64_t key, unsigned int program) {
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            return;
+        }
+        std::vector<char> binary(static_cast<size_t>(length));
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.driverHash = driverHash;
+        header.format = format;
+        header.length = static_cast<uint32_t>(length);
+
+        // write to a temporary file first so a crash never leaves a torn entry behind
+        const std::filesystem::path path = entryPath(key);
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+            if (!file) {
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (!error) {
+            stats.stored++;
+        }
+    }
+
+public:
+    // needs a current GL context to read the driver strings
+    explicit ProgramCache(std::filesystem::path directory = "program_cache") : directory(std::move(directory)) {
+        std::string driver;
+        for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION}) {
+            const auto* value = reinterpret_cast<const char*>(glGetString(name));
+            driver += value ? value : "";
+            driver += '|';
+        }
+        driverHash = hashString(driver);
+
+        int formats = 0;
+        if (GLAD_GL_VERSION_4_1) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        }
+        supported = formats > 0;
+        if (supported) {
+            std::error_code error;
+            std::filesystem::create_directories(this->directory, error);
+            supported = !error;
+        }
+        if (!supported) {
+            std::cout << "Program binaries not supported, shaders will always be compiled" << std::endl;
+        }
+    }
+
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    // restores the program from disk if possible, otherwise compiles it and stores the binary
+    Shader getShader(const std::string &vertexCode, const std::string &fragmentCode) {
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t key = hashCombine(hashCombine(hashString(vertexCode), hashString(fragmentCode)), driverHash);
+
+        if (supported) {
+            if (const unsigned int program = loadBinary(key)) {
+                stats.hits++;
+                stats.loadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                return Shader::fromProgram(program);
+            }
+        }
+
+        stats.misses++;
+        Shader shader = Shader::fromSource(vertexCode, fragmentCode, supported);
+        if (supported && shader.isLinked()) {
+            storeBinary(key, shader.getId());
+        }
+        stats.compileMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return shader;
+    }
+
+    [[nodiscard]] bool isSupported() const {
+        return supported;
+    }
+
+    [[nodiscard]] const ProgramCacheStats &getStats() const {
+        return stats;
+    }
+};
+
+#endif //LEARNOPENGL_PROGRAM_CACHE_H
@@ -0,0 +1,256 @@
+#ifndef LEARNOPENGL_RESOURCE_CACHE_H
+#define LEARNOPENGL_RESOURCE_CACHE_H
+
+#include <glad/glad.h>
+#include "shaders.h"
+#include "structs/shapes.h"
+#include "structs/vertex_layout.h"
+#include "resources/mesh_file.h"
+#include "resources/texture_loader.h"
+#include "resources/hash.h"
+#include "resources/program_cache.h"
+#include "resources/shader_reloader.h"
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+struct ResourceStats {
+    unsigned int shaders = 0;
+    unsigned int textures = 0;
+    unsigned int meshes = 0;
+    size_t shaderBytes = 0;  // program binary size when the driver reports it
+    size_t textureBytes = 0; // resident textures only, placeholders aren't counted
+    size_t meshBytes = 0;
+    unsigned int hits = 0;   // requests served from the cache
+    unsigned int misses = 0; // requests that created a new GL object
+
+    [[nodiscard]] size_t totalBytes() const {
+        return shaderBytes + textureBytes + meshBytes;
+    }
+};
+
+inline std::ostream &operator<<(std::ostream &out, const ResourceStats &stats) {
+    out << "resources: " << stats.shaders << " shaders (" << stats.shaderBytes << " B), "
+        << stats.textures << " textures (" << stats.textureBytes << " B), "
+        << stats.meshes << " meshes (" << stats.meshBytes << " B), "
+        << stats.totalBytes() << " B total, " << stats.hits << " hits / " << stats.misses << " misses";
+    return out;
+}
+
+// Hands out shared GL objects keyed by path and by content hash, so asking for
+// the same shader pair, image or vertex data twice returns the same object.
+// Textures are only keyed by path here, the loader's workers find images with
+// the same contents so no file is read on the GL thread.
+// The cache only keeps weak references: a resource is deleted when its last
+// user lets go of it, which must happen on the GL thread.
+class ResourceCache {
+private:
+    // content maps are keyed by a hash of data that has to be read anyway, path maps by the
+    // paths themselves so two paths can never collide into one resource
+    template<typename T>
+    using WeakMap = std::unordered_map<uint64_t, std::weak_ptr<T>>;
+    template<typename T>
+    using PathMap = std::unordered_map<std::string, std::weak_ptr<T>>;
+
+    TextureLoader &textureLoader;
+    ProgramCache* programCache; // optional, compiles from source when null
+    ShaderReloader* shaderReloader; // optional, rebuilds shaders when their files change
+    PathMap<Shader> shadersByPath;
+    WeakMap<Shader> shadersByContent;
+    PathMap<TextureSlot> texturesByPath;
+    WeakMap<Mesh> meshesByContent;
+    PathMap<Mesh> meshesByPath;
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+
+    template<typename Map>
+    static auto find(const Map &map, const typename Map::key_type &key) {
+        const auto it = map.find(key);
+        return it == map.end() ? nullptr : it->second.lock();
+    }
+
+    // two paths in one key, '\0' can't be part of either
+    static std::string pathPair(const std::string &first, const std::string &second) {
+        std::string key = first;
+        key += '\0';
+        key += second;
+        return key;
+    }
+
+    // drop entries whose resource has already been released
+    template<typename Map>
+    static void prune(Map &map) {
+        for (auto it = map.begin(); it != map.end();) {
+            it = it->second.expired() ? map.erase(it) : std::next(it);
+        }
+    }
+
+public:
+    explicit ResourceCache(TextureLoader &textureLoader, ProgramCache* programCache = nullptr,
+                           ShaderReloader* shaderReloader = nullptr)
+        : textureLoader(textureLoader), programCache(programCache), shaderReloader(shaderReloader) {}
+
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
+
+    std::shared_ptr<Shader> getShader(const std::string &vertexPath, const std::string &fragmentPath) {
+        const std::string pathKey = pathPair(vertexPath, fragmentPath);
+        if (auto shader = find(shadersByPath, pathKey)) {
+            hits++;
+            return shader;
+        }
+        // different paths can still hold the same code. Not with hot reload though: an edit to one
+        // pair would swap the program under the other, and leave the content key on code it no longer runs
+        const std::string vertexCode = Shader::readFile(vertexPath.c_str());
+        const std::string fragmentCode = Shader::readFile(fragmentPath.c_str());
+        const uint64_t contentKey = hashCombine(hashString(vertexCode), hashString(fragmentCode));
+        auto shader = shaderReloader ? nullptr : find(shadersByContent, contentKey);
+        if (shader) {
+            hits++;
+        } else {
+            misses++;
+            Shader built = programCache ? programCache->getShader(vertexCode, fragmentCode)
+                                        : Shader::fromSource(vertexCode, fragmentCode);
+            shader = std::shared_ptr<Shader>(new Shader(built),
+                                             [](Shader* s) {
+                                                 glDeleteProgram(s->getId());
+                                                 delete s;
+                                             });
+            if (!shaderReloader) {
+                shadersByContent[contentKey] = shader;
+            }
+        }
+        shadersByPath[pathKey] = shader;
+        if (shaderReloader) {
+            shaderReloader->watch(vertexPath, fragmentPath, shader);
+        }
+        return shader;
+    }
+
+    TextureHandle getTexture(const std::string &path) {
+        if (auto slot = find(texturesByPath, path)) {
+            hits++;
+            return TextureHandle(slot, textureLoader.getPlaceholder());
+        }
+        misses++;
+        TextureHandle texture = textureLoader.load(path);
+        texturesByPath[path] = texture.getSlot();
+        return texture;
+    }
+
+    // interleaved vertices described by layout, 32 bit indices
+    std::shared_ptr<Mesh> getMesh(const void* vertices, size_t vertexSize, const unsigned int* indices,
+                                  size_t indexSize, const VertexLayout &layout = VertexLayout::positionColorTexCoord()) {
+        uint64_t key = hashBytes(indices, indexSize, hashBytes(vertices, vertexSize));
+        for (const VertexAttribute &attribute : layout.attributes) {
+            const uint32_t fields[5] = {attribute.location, static_cast<uint32_t>(attribute.components), attribute.type,
+                                        attribute.normalized ? 1u : 0u, attribute.offset};
+            key = hashBytes(fields, sizeof(fields), key);
+        }
+        if (auto mesh = find(meshesByContent, key)) {
+            hits++;
+            return mesh;
+        }
+        misses++;
+        auto mesh = std::make_shared<Mesh>();
+        mesh->indexCount = static_cast<unsigned int>(indexSize / sizeof(unsigned int));
+        mesh->bytes = vertexSize + indexSize;
+
+        glGenVertexArrays(1, &mesh->VAO);
+        glBindVertexArray(mesh->VAO);
+
+        glGenBuffers(1, &mesh->VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh->VBO);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertexSize), vertices, GL_STATIC_DRAW);
+
+        glGenBuffers(1, &mesh->EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indexSize), indices, GL_STATIC_DRAW);
+
+        layout.apply();
+
+        glBindVertexArray(0);
+
+        meshesByContent[key] = mesh;
+        return mesh;
+    }
+
+    // a mesh from an .lmesh file, mapped and uploaded on first use. Keyed by path
+    // and name only, hashing the contents would read the whole file
+    std::shared_ptr<Mesh> getMeshFile(const std::string &path, const std::string &name = "") {
+        const std::string key = pathPair(path, name);
+        if (auto mesh = find(meshesByPath, key)) {
+            hits++;
+            return mesh;
+        }
+        MeshFile file;
+        if (!file.open(path) || file.getMeshCount() == 0) {
+            return nullptr;
+        }
+        const int index = name.empty() ? 0 : file.find(name);
+        if (index < 0) {
+            std::cout << "No mesh called " << name << " in " << path << std::endl;
+            return nullptr;
+        }
+        misses++;
+        std::shared_ptr<Mesh> mesh = file.upload(static_cast<size_t>(index));
+        if (mesh) {
+            meshesByPath[key] = mesh;
+        }
+        return mesh;
+    }
+
+    // counts everything still referenced by someone
+    ResourceStats getStats() {
+        prune(shadersByPath);
+        prune(shadersByContent);
+        prune(texturesByPath);
+        prune(meshesByContent);
+        prune(meshesByPath);
+
+        ResourceStats stats;
+        stats.hits = hits;
+        stats.misses = misses;
+        // shadersByPath covers every shader, paths sharing code share one program, count it once
+        std::unordered_set<const Shader*> seenShaders;
+        for (const auto &entry : shadersByPath) {
+            if (auto shader = entry.second.lock(); shader && seenShaders.insert(shader.get()).second) {
+                stats.shaders++;
+                int length = 0;
+                if (GLAD_GL_VERSION_4_1) {
+                    glGetProgramiv(shader->getId(), GL_PROGRAM_BINARY_LENGTH, &length);
+                }
+                stats.shaderBytes += static_cast<size_t>(length);
+            }
+        }
+        // paths with the same contents share one GL texture, count it once
+        std::unordered_set<const TextureSlot*> seen;
+        for (const auto &entry : texturesByPath) {
+            auto slot = entry.second.lock();
+            const TextureSlot* owner = slot && slot->shared ? slot->shared.get() : slot.get();
+            if (!owner || !seen.insert(owner).second) {
+                continue;
+            }
+            stats.textures++;
+            if (owner->ready.load(std::memory_order_acquire)) {
+                stats.textureBytes += owner->bytes;
+            }
+        }
+        const auto countMeshes = [&stats](const auto &meshes) {
+            for (const auto &entry : meshes) {
+                if (auto mesh = entry.second.lock()) {
+                    stats.meshes++;
+                    stats.meshBytes += mesh->bytes;
+                }
+            }
+        };
+        countMeshes(meshesByContent);
+        countMeshes(meshesByPath);
+        return stats;
+    }
+};
+
+#endif //LEARNOPENGL_RESOURCE_CACHE_H
@@ -0,0 +1,259 @@
+#ifndef LEARNOPENGL_SHADER_RELOADER_H
+#define LEARNOPENGL_SHADER_RELOADER_H
+
+#include <glad/glad.h>
+#include "shaders.h"
+#include "resources/file_watcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct ShaderReloadStats {
+    unsigned int reloads = 0;  // programs swapped in
+    unsigned int failures = 0; // edits that didn't compile or link, the previous program kept drawing
+    double lastMs = 0.0;        // from the watcher noticing the edit to the new program being swapped in
+    double lastCompileMs = 0.0; // from handing the sources to the driver to it reporting completion
+    double updateMs = 0.0;      // GL thread time spent in update(), summed
+    bool parallel = false;      // compiled on the driver's threads through GL_KHR_parallel_shader_compile
+};
+
+inline std::ostream &operator<<(std::ostream &out, const ShaderReloadStats &stats) {
+    out << "shader reload: " << stats.reloads << " reloads, " << stats.failures << " failed, last "
+        << stats.lastMs << " ms (compile " << stats.lastCompileMs << " ms), " << stats.updateMs
+        << " ms on the GL thread, " << (stats.parallel ? "parallel" : "blocking") << " compile";
+    return out;
+}
+
+// Recompiles a shader when one of its source files changes and swaps the new
+// program into the existing Shader at the start of a frame, so every material
+// holding it draws with the new program without being touched. A program that
+// fails to compile or link is thrown away and the previous one keeps drawing.
+// With GL_KHR_parallel_shader_compile the driver compiles on its own threads and
+// update() only polls for completion, otherwise update() waits for the compile.
+class ShaderReloader {
+private:
+    using Clock = std::chrono::steady_clock;
+    // glad was generated without extensions, these come from GL_KHR_parallel_shader_compile
+    static constexpr GLenum COMPLETION_STATUS = 0x91B1;
+    using MaxShaderCompilerThreadsProc = void (APIENTRYP)(GLuint count);
+
+    struct Watched {
+        std::string vertexPath; // canonical, as the watcher reports them
+        std::string fragmentPath;
+        std::weak_ptr<Shader> shader;
+    };
+    // sources read on the watcher thread, waiting for the GL thread
+    struct Edit {
+        size_t watched;
+        std::string vertexCode;
+        std::string fragmentCode;
+        Clock::time_point noticed;
+    };
+    // a program the driver may still be compiling
+    struct Build {
+        size_t watched;
+        unsigned int vertex;
+        unsigned int fragment;
+        unsigned int program;
+        Clock::time_point noticed;
+        Clock::time_point submitted;
+    };
+
+    std::mutex mutex;
+    std::vector<Watched> watched; // guarded by mutex, never shrinks so indices stay valid
+    std::vector<Edit> edits;      // guarded by mutex
+    std::vector<Build> builds;
+    bool parallel = false;
+    ShaderReloadStats stats;
+    FileWatcher watcher; // last, so its thread stops before anything it uses is destroyed
+
+    static bool extensionSupported(const char* extension) {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++) {
+            const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<unsigned int>(i)));
+            if (name && std::strcmp(name, extension) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static double millisecondsBetween(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    // watcher thread: read the sources of every program using the file
+    void onFileChanged(const std::string &path) {
+        const auto noticed = Clock::now();
+        std::vector<Watched> affected;
+        std::vector<size_t> indices;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t i = 0; i < watched.size(); i++) {
+                if (watched[i].vertexPath == path || watched[i].fragmentPath == path) {
+                    affected.push_back(watched[i]);
+                    indices.push_back(i);
+                }
+            }
+        }
+        for (size_t i = 0; i < affected.size(); i++) {
+            Edit edit{indices[i], Shader::readFile(affected[i].vertexPath.c_str()),
+                      Shader::readFile(affected[i].fragmentPath.c_str()), noticed};
+            if (edit.vertexCode.empty() || edit.fragmentCode.empty()) {
+                continue; // truncated while being saved, the write that completes it comes next
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            // a newer edit replaces one the GL thread hasn't picked up yet
+            edits.erase(std::remove_if(edits.begin(), edits.end(),
+                                       [&edit](const Edit &pending) { return pending.watched == edit.watched; }),
+                        edits.end());
+            edits.push_back(std::move(edit));
+        }
+    }
+
+    static void release(const Build &build) {
+        glDeleteShader(build.vertex);
+        glDeleteShader(build.fragment);
+        glDeleteProgram(build.program);
+    }
+
+    void start(const Edit &edit) {
+        // a build of an older version of the same files is no longer interesting
+        for (auto it = builds.begin(); it != builds.end();) {
+            if (it->watched == edit.watched) {
+                release(*it);
+                it = builds.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        Build build{};
+        build.watched = edit.watched;
+        build.noticed = edit.noticed;
+        build.submitted = Clock::now();
+        build.vertex = Shader::compileStage(GL_VERTEX_SHADER, edit.vertexCode);
+        build.fragment = Shader::compileStage(GL_FRAGMENT_SHADER, edit.fragmentCode);
+        // linking is queued behind the compiles, it simply fails if one of them does
+        build.program = Shader::linkProgram(build.vertex, build.fragment);
+        builds.push_back(build);
+    }
+
+    void finish(const Build &build) {
+        Watched target;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            target = watched[build.watched];
+        }
+        const bool vertexCompiled = Shader::checkCompiled(build.vertex, "VERTEX");
+        const bool fragmentCompiled = Shader::checkCompiled(build.fragment, "FRAGMENT");
+        const bool built = vertexCompiled && fragmentCompiled && Shader::checkLinked(build.program);
+        // without parallel compile the status queries above are where the compile actually waits
+        const auto completed = Clock::now();
+        const std::shared_ptr<Shader> shader = target.shader.lock();
+        if (built && shader) {
+            glDeleteProgram(shader->replaceProgram(build.program));
+            glDeleteShader(build.vertex);
+            glDeleteShader(build.fragment);
+            stats.reloads++;
+            stats.lastCompileMs = millisecondsBetween(build.submitted, completed);
+            stats.lastMs = millisecondsBetween(build.noticed, Clock::now());
+            std::cout << "Reloaded " << target.vertexPath << " + " << target.fragmentPath << " in " << stats.lastMs
+                      << " ms (compile " << stats.lastCompileMs << " ms)" << std::endl;
+            return;
+        }
+        release(build);
+        if (shader) {
+            stats.failures++;
+            std::cout << "Reloading " << target.vertexPath << " + " << target.fragmentPath
+                      << " failed, keeping the previous program" << std::endl;
+        }
+    }
+
+public:
+    // needs a current GL context, loader looks up glMaxShaderCompilerThreadsKHR (glfwGetProcAddress / eglGetProcAddress)
+    explicit ShaderReloader(GLADloadproc loader = nullptr)
+        : watcher([this](const std::string &path) { onFileChanged(path); }) {
+        parallel = extensionSupported("GL_KHR_parallel_shader_compile") ||
+                   extensionSupported("GL_ARB_parallel_shader_compile");
+        if (parallel && loader != nullptr) {
+            // let the driver pick how many threads it compiles on
+            auto maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(loader("glMaxShaderCompilerThreadsKHR"));
+            if (maxThreads == nullptr) {
+                maxThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(loader("glMaxShaderCompilerThreadsARB"));
+            }
+            if (maxThreads != nullptr) {
+                maxThreads(0xFFFFFFFFu);
+            }
+        }
+        stats.parallel = parallel;
+        std::cout << "shader hot reload: " << (watcher.isPolling() ? "polling" : "inotify") << ", "
+                  << (parallel ? "parallel" : "blocking") << " compile" << std::endl;
+    }
+
+    // drops unfinished builds, call on the GL thread
+    ~ShaderReloader() {
+        for (const Build &build : builds) {
+            release(build);
+        }
+    }
+
+    ShaderReloader(const ShaderReloader&) = delete;
+    ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+    // rebuilds shader whenever either file is written
+    void watch(const std::string &vertexPath, const std::string &fragmentPath, const std::shared_ptr<Shader> &shader) {
+        Watched entry{FileWatcher::canonicalPath(vertexPath), FileWatcher::canonicalPath(fragmentPath), shader};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const Watched &existing : watched) {
+                if (existing.vertexPath == entry.vertexPath && existing.fragmentPath == entry.fragmentPath &&
+                    existing.shader.lock() == shader) {
+                    return;
+                }
+            }
+            watched.push_back(entry);
+        }
+        watcher.watch(entry.vertexPath);
+        watcher.watch(entry.fragmentPath);
+    }
+
+    // call once per frame on the GL thread before drawing: starts compiling new edits
+    // and swaps in every program the driver has finished
+    void update() {
+        const auto begin = Clock::now();
+        std::vector<Edit> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.swap(edits);
+        }
+        for (const Edit &edit : ready) {
+            start(edit);
+        }
+        for (auto it = builds.begin(); it != builds.end();) {
+            int complete = GL_TRUE;
+            if (parallel) {
+                glGetProgramiv(it->program, COMPLETION_STATUS, &complete);
+            }
+            if (complete == GL_FALSE) {
+                ++it;
+                continue;
+            }
+            finish(*it);
+            it = builds.erase(it);
+        }
+        stats.updateMs += millisecondsBetween(begin, Clock::now());
+    }
+
+    [[nodiscard]] const ShaderReloadStats &getStats() const {
+        return stats;
+    }
+};
+
+#endif //LEARNOPENGL_SHADER_RELOADER_H
@@ -0,0 +1,526 @@
+#ifndef LEARNOPENGL_TEXTURE_ATLAS_H
+#define LEARNOPENGL_TEXTURE_ATLAS_H
+
+#include <glad/glad.h>
+#include "external/stb_image/stb_image.h"
+#include "resources/block_compression.h"
+#include "resources/hash.h"
+#include "resources/texture_loader.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct TextureAtlasStats {
+    unsigned int images = 0;
+    int width = 0;
+    int height = 0;
+    int mipLevels = 0;
+    const char* format = "none";
+    size_t bytes = 0;         // GPU memory including the mip chain
+    size_t separateBytes = 0; // the same images as one RGBA8 texture each, the way TextureLoader uploads them
+    bool cacheHit = false;
+    double buildMs = 0.0;     // decoding, packing, mipmapping and compressing, 0 on a cache hit
+    double loadMs = 0.0;      // reading the cache entry and uploading
+};
+
+inline std::ostream &operator<<(std::ostream &out, const TextureAtlasStats &stats) {
+    out << "texture atlas: " << stats.images << " images in " << stats.width << "x" << stats.height << " "
+        << stats.format << " with " << stats.mipLevels << " mip levels, " << stats.bytes << " B (vs "
+        << stats.separateBytes << " B as separate textures), " << (stats.cacheHit ? "cache hit" : "built")
+        << " in " << stats.buildMs + stats.loadMs << " ms";
+    return out;
+}
+
+// Packs many images into one GL_TEXTURE_2D so quads using any of them can share a
+// single texture bind and therefore a single instanced draw.
+// Images are placed on shelves, each surrounded by a gutter of repeated edge pixels
+// so neither bilinear filtering nor the precomputed mip levels bleed neighbours in.
+// The finished mip chain is block compressed on the CPU (BC1, or BC3 when an image
+// has alpha) and kept in an on-disk cache keyed by the image paths, sizes and
+// modification times, so later launches go straight from the file to
+// glCompressedTexImage2D without reading a single image.
+// Drivers without S3TC get the same atlas as RGBA8. Atlas coordinates only cover
+// 0..1 per image, textures that need GL_REPEAT should stay standalone.
+class TextureAtlas {
+private:
+    struct Entry {
+        std::string name;
+        int x = 0; // level 0 pixels, without the gutter
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> data; // RGBA8 or compressed blocks, depending on the atlas format
+    };
+
+    // file layout: header, then per entry its name length, name and rect, then per level its size and data
+    struct FileHeader {
+        char magic[8];
+        uint32_t format;
+        int32_t width;
+        int32_t height;
+        uint32_t levels;
+        uint32_t entries;
+    };
+    static constexpr char MAGIC[8] = {'L', 'O', 'G', 'L', 'A', 'T', 'L', '1'};
+
+    static constexpr int GUTTER = 8;
+    static constexpr int MIP_LEVELS = 4; // the gutter is still a pixel wide in the last one
+    static constexpr int ALIGN = 4 << (MIP_LEVELS - 1); // cells stay on whole compression blocks in every level
+
+    // from EXT_texture_compression_s3tc, glad was generated without extensions
+    static constexpr GLenum COMPRESSED_RGB_S3TC_DXT1 = 0x83F0;
+    static constexpr GLenum COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+
+    std::filesystem::path directory;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> lookup;
+    std::shared_ptr<TextureSlot> slot = std::make_shared<TextureSlot>();
+    GLenum internalFormat = GL_RGBA8;
+    TextureAtlasStats stats;
+
+    // stands in for the contents when keying the cache, reading every image would cost as much as decoding it
+    static uint64_t fileVersion(const std::string &path) {
+        std::error_code error;
+        const uint64_t size = std::filesystem::file_size(path, error);
+        if (error) {
+            return 0; // missing files still get a key, they're built as a magenta square
+        }
+        const auto writeTime = std::filesystem::last_write_time(path, error);
+        const auto ticks = error ? 0 : static_cast<uint64_t>(writeTime.time_since_epoch().count());
+        return hashCombine(size, ticks);
+    }
+
+    static int nextPowerOfTwo(int value) {
+        int result = 1;
+        while (result < value) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    static int alignUp(int value) {
+        return (value + ALIGN - 1) / ALIGN * ALIGN;
+    }
+
+    // bytes of one level in format, 0 for a format the atlas never writes
+    static uint64_t levelBytes(GLenum format, int width, int height) {
+        const auto w = static_cast<uint64_t>(width);
+        const auto h = static_cast<uint64_t>(height);
+        switch (format) {
+            case GL_RGBA8: return w * h * 4;
+            case COMPRESSED_RGB_S3TC_DXT1: return ((w + 3) / 4) * ((h + 3) / 4) * 8;
+            case COMPRESSED_RGBA_S3TC_DXT5: return ((w + 3) / 4) * ((h + 3) / 4) * 16;
+            default: return 0;
+        }
+    }
+
+    static const char* formatName(GLenum format) {
+        switch (format) {
+            case COMPRESSED_RGB_S3TC_DXT1: return "BC1";
+            case COMPRESSED_RGBA_S3TC_DXT5: return "BC3";
+            default: return "RGBA8";
+        }
+    }
+
+    [[nodiscard]] std::filesystem::path entryPath(uint64_t key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.atlas", static_cast<unsigned long long>(key));
+        return directory / name;
+    }
+
+    // shelf packing, tallest images first, in the smallest power of two square-ish atlas they fit
+    void pack(int &atlasWidth, int &atlasHeight) {
+        std::vector<size_t> order(entries.size());
+        size_t area = 0;
+        int widest = 0;
+        for (size_t i = 0; i < entries.size(); i++) {
+            order[i] = i;
+            const int cellWidth = alignUp(entries[i].width + 2 * GUTTER);
+            area += static_cast<size_t>(cellWidth) * static_cast<size_t>(alignUp(entries[i].height + 2 * GUTTER));
+            widest = std::max(widest, cellWidth);
+        }
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return entries[a].height > entries[b].height;
+        });
+
+        atlasWidth = std::max(nextPowerOfTwo(static_cast<int>(std::sqrt(static_cast<double>(area)))),
+                              nextPowerOfTwo(widest));
+        for (;;) {
+            int x = 0;
+            int y = 0;
+            int shelfHeight = 0;
+            for (const size_t i : order) {
+                Entry &entry = entries[i];
+                const int cellWidth = alignUp(entry.width + 2 * GUTTER);
+                const int cellHeight = alignUp(entry.height + 2 * GUTTER);
+                if (x + cellWidth > atlasWidth) {
+                    x = 0;
+                    y += shelfHeight;
+                    shelfHeight = 0;
+                }
+                entry.x = x + GUTTER;
+                entry.y = y + GUTTER;
+                x += cellWidth;
+                shelfHeight = std::max(shelfHeight, cellHeight);
+            }
+            atlasHeight = nextPowerOfTwo(y + shelfHeight);
+            if (atlasHeight <= atlasWidth) {
+                return;
+            }
+            atlasWidth *= 2;
+        }
+    }
+
+    // level 0 with every image and its gutter, then each further level as a 2x2 box filter of the one before
+    std::vector<Level> buildLevels(const std::vector<std::vector<unsigned char>> &images, int width, int height) const {
+        std::vector<Level> levels(1);
+        Level &base = levels[0];
+        base.width = width;
+        base.height = height;
+        base.data.assign(static_cast<size_t>(width) * static_cast<size_t>(height) * 4, 0);
+        for (size_t i = 0; i < entries.size(); i++) {
+            const Entry &entry = entries[i];
+            const int cellRight = entry.x - GUTTER + alignUp(entry.width + 2 * GUTTER);
+            const int cellBottom = entry.y - GUTTER + alignUp(entry.height + 2 * GUTTER);
+            for (int y = entry.y - GUTTER; y < cellBottom; y++) {
+                const int sourceY = std::clamp(y - entry.y, 0, entry.height - 1);
+                for (int x = entry.x - GUTTER; x < cellRight; x++) {
+                    const int sourceX = std::clamp(x - entry.x, 0, entry.width - 1);
+                    std::memcpy(&base.data[(static_cast<size_t>(y) * static_cast<size_t>(width) + static_cast<size_t>(x)) * 4],
+                                &images[i][(static_cast<size_t>(sourceY) * static_cast<size_t>(entry.width) +
+                                            static_cast<size_t>(sourceX)) * 4], 4);
+                }
+            }
+        }
+
+        for (int level = 1; level < MIP_LEVELS && (levels.back().width > 1 || levels.back().height > 1); level++) {
+            const Level &source = levels.back();
+            Level next;
+            next.width = std::max(1, source.width / 2);
+            next.height = std::max(1, source.height / 2);
+            next.data.resize(static_cast<size_t>(next.width) * static_cast<size_t>(next.height) * 4);
+            for (int y = 0; y < next.height; y++) {
+                const int y0 = std::min(2 * y, source.height - 1);
+                const int y1 = std::min(2 * y + 1, source.height - 1);
+                for (int x = 0; x < next.width; x++) {
+                    const int x0 = std::min(2 * x, source.width - 1);
+                    const int x1 = std::min(2 * x + 1, source.width - 1);
+                    for (int c = 0; c < 4; c++) {
+                        const auto at = [&](int px, int py) {
+                            return static_cast<int>(source.data[(static_cast<size_t>(py) * static_cast<size_t>(source.width) +
+                                                                 static_cast<size_t>(px)) * 4 + static_cast<size_t>(c)]);
+                        };
+                        next.data[(static_cast<size_t>(y) * static_cast<size_t>(next.width) + static_cast<size_t>(x)) * 4 +
+                                  static_cast<size_t>(c)] =
+                                static_cast<unsigned char>((at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1) + 2) / 4);
+                    }
+                }
+            }
+            levels.push_back(std::move(next));
+        }
+        return levels;
+    }
+
+    // decodes every image and builds the finished mip chain, failed images become a magenta square
+    std::vector<Level> build(const std::vector<std::string> &paths, bool compress) {
+        std::vector<std::vector<unsigned char>> images;
+        bool opaque = true;
+        for (const std::string &path : paths) {
+            Entry entry;
+            entry.name = path;
+            int channels;
+            unsigned char* pixels = stbi_load(path.c_str(), &entry.width, &entry.height, &channels, 4);
+            std::vector<unsigned char> image;
+            if (pixels) {
+                image.assign(pixels, pixels + static_cast<size_t>(entry.width) * static_cast<size_t>(entry.height) * 4);
+                stbi_image_free(pixels);
+            } else {
+                std::cout << "Failed to load texture " << path << std::endl;
+                entry.width = 4;
+                entry.height = 4;
+                for (int i = 0; i < 16; i++) {
+                    image.insert(image.end(), {255, 0, 255, 255});
+                }
+            }
+            for (size_t i = 3; i < image.size() && opaque; i += 4) {
+                opaque = image[i] == 255;
+            }
+            stats.separateBytes += image.size() + image.size() / 3;
+            entries.push_back(entry);
+            images.push_back(std::move(image));
+        }
+
+        int width = 0;
+        int height = 0;
+        pack(width, height);
+        std::vector<Level> levels = buildLevels(images, width, height);
+        if (compress) {
+            const BlockFormat format = opaque ? BlockFormat::BC1 : BlockFormat::BC3;
+            internalFormat = opaque ? COMPRESSED_RGB_S3TC_DXT1 : COMPRESSED_RGBA_S3TC_DXT5;
+            for (Level &level : levels) {
+                level.data = compressImage(format, level.data.data(), level.width, level.height);
+            }
+        }
+        return levels;
+    }
+
+    // every count and length is checked against what's left of the file before anything is
+    // allocated, a truncated or corrupt entry is rejected and the atlas rebuilt
+    bool loadCache(uint64_t key, std::vector<Level> &levels) {
+        const std::filesystem::path path = entryPath(key);
+        std::error_code error;
+        uint64_t remaining = std::filesystem::file_size(path, error);
+        if (error) {
+            return false;
+        }
+        std::ifstream file(path, std::ios::binary);
+        const auto read = [&file, &remaining](void* data, uint64_t size) {
+            if (size > remaining) {
+                return false;
+            }
+            file.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+            remaining -= size;
+            return static_cast<bool>(file);
+        };
+        FileHeader header{};
+        if (!file || !read(&header, sizeof(header)) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            return false;
+        }
+        if (levelBytes(header.format, 1, 1) == 0 || header.width <= 0 || header.height <= 0 || header.levels == 0 ||
+            header.levels > MIP_LEVELS) {
+            return false;
+        }
+        // an entry is at least its name length and rect
+        if (header.entries > remaining / (sizeof(uint32_t) + 4 * sizeof(int32_t))) {
+            return false;
+        }
+        std::vector<Entry> loaded(header.entries);
+        for (Entry &entry : loaded) {
+            uint32_t length = 0;
+            if (!read(&length, sizeof(length)) || length > remaining) {
+                return false;
+            }
+            entry.name.resize(length);
+            int32_t rect[4] = {};
+            if (!read(entry.name.data(), length) || !read(rect, sizeof(rect))) {
+                return false;
+            }
+            entry.x = rect[0];
+            entry.y = rect[1];
+            entry.width = rect[2];
+            entry.height = rect[3];
+            if (entry.x < 0 || entry.y < 0 || entry.width <= 0 || entry.height <= 0 ||
+                entry.width > header.width - entry.x || entry.height > header.height - entry.y) {
+                return false;
+            }
+        }
+        levels.resize(header.levels);
+        int width = header.width;
+        int height = header.height;
+        for (Level &level : levels) {
+            int32_t size[2] = {};
+            uint64_t length = 0;
+            if (!read(size, sizeof(size)) || !read(&length, sizeof(length))) {
+                return false;
+            }
+            // each level halves the previous one, and its data is exactly what the format needs for that size
+            if (size[0] != width || size[1] != height || length != levelBytes(header.format, width, height) ||
+                length > remaining) {
+                return false;
+            }
+            level.width = width;
+            level.height = height;
+            level.data.resize(length);
+            if (!read(level.data.data(), length)) {
+                return false;
+            }
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        entries = std::move(loaded);
+        internalFormat = header.format;
+        for (const Entry &entry : entries) {
+            const auto bytes = static_cast<size_t>(entry.width) * static_cast<size_t>(entry.height) * 4;
+            stats.separateBytes += bytes + bytes / 3;
+        }
+        return true;
+    }
+
+    void storeCache(uint64_t key, const std::vector<Level> &levels) const {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.format = internalFormat;
+        header.width = levels[0].width;
+        header.height = levels[0].height;
+        header.levels = static_cast<uint32_t>(levels.size());
+        header.entries = static_cast<uint32_t>(entries.size());
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        // write to a temporary file first so a crash never leaves a torn entry behind
+        const std::filesystem::path path = entryPath(key);
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (const Entry &entry : entries) {
+                const auto length = static_cast<uint32_t>(entry.name.size());
+                const int32_t rect[4] = {entry.x, entry.y, entry.width, entry.height};
+                file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                file.write(entry.name.data(), length);
+                file.write(reinterpret_cast<const char*>(rect), sizeof(rect));
+            }
+            for (const Level &level : levels) {
+                const int32_t size[2] = {level.width, level.height};
+                const uint64_t length = level.data.size();
+                file.write(reinterpret_cast<const char*>(size), sizeof(size));
+                file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+                file.write(reinterpret_cast<const char*>(level.data.data()), static_cast<std::streamsize>(length));
+            }
+            if (!file) {
+                return;
+            }
+        }
+        std::filesystem::rename(temporary, path, error);
+    }
+
+    void upload(const std::vector<Level> &levels) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        // the gutters stand in for clamping between images, clamp at the atlas edge as well
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<int>(levels.size()) - 1);
+        size_t bytes = 0;
+        for (size_t level = 0; level < levels.size(); level++) {
+            const Level &data = levels[level];
+            if (internalFormat == GL_RGBA8) {
+                glTexImage2D(GL_TEXTURE_2D, static_cast<int>(level), GL_RGBA8, data.width, data.height, 0, GL_RGBA,
+                             GL_UNSIGNED_BYTE, data.data.data());
+            } else {
+                glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<int>(level), internalFormat, data.width, data.height,
+                                       0, static_cast<GLsizei>(data.data.size()), data.data.data());
+            }
+            bytes += data.data.size();
+        }
+
+        slot->texture = texture;
+        slot->width = levels[0].width;
+        slot->height = levels[0].height;
+        slot->bytes = bytes;
+        slot->ready.store(true, std::memory_order_release);
+
+        stats.width = levels[0].width;
+        stats.height = levels[0].height;
+        stats.mipLevels = static_cast<int>(levels.size());
+        stats.format = formatName(internalFormat);
+        stats.bytes = bytes;
+    }
+
+public:
+    // true when the driver takes BC1/BC3 data, checked at runtime since it's an extension
+    static bool compressionSupported() {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++) {
+            const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<unsigned int>(i)));
+            if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // builds the atlas from the image files, or restores it from the cache directory if
+    // the same files were packed before. Needs a current GL context.
+    explicit TextureAtlas(const std::vector<std::string> &paths, std::filesystem::path cacheDirectory = "texture_cache")
+        : directory(std::move(cacheDirectory)) {
+        const auto start = std::chrono::steady_clock::now();
+        const bool compress = compressionSupported();
+        if (!compress) {
+            std::cout << "S3TC texture compression not supported, the texture atlas stays RGBA8" << std::endl;
+        }
+
+        uint64_t key = hashString(compress ? "s3tc" : "rgba8");
+        key = hashCombine(key, static_cast<uint64_t>(GUTTER * 100 + MIP_LEVELS));
+        for (const std::string &path : paths) {
+            key = hashCombine(key, hashCombine(hashString(path), fileVersion(path)));
+        }
+
+        std::vector<Level> levels;
+        stats.cacheHit = !paths.empty() && loadCache(key, levels);
+        if (!stats.cacheHit) {
+            entries.clear();
+            stats.separateBytes = 0;
+            levels = build(paths, compress);
+            stats.buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (!paths.empty()) {
+                storeCache(key, levels);
+            }
+        }
+        for (size_t i = 0; i < entries.size(); i++) {
+            lookup.emplace(entries[i].name, i);
+        }
+        stats.images = static_cast<unsigned int>(entries.size());
+
+        const auto uploadStart = std::chrono::steady_clock::now();
+        if (!levels.empty() && !levels[0].data.empty()) {
+            upload(levels);
+        }
+        const auto end = std::chrono::steady_clock::now();
+        stats.loadMs = std::chrono::duration<double, std::milli>(end - (stats.cacheHit ? start : uploadStart)).count();
+    }
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // index of the image loaded from path, -1 if it isn't in the atlas
+    [[nodiscard]] int find(const std::string &path) const {
+        const auto it = lookup.find(path);
+        return it == lookup.end() ? -1 : static_cast<int>(it->second);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return entries.size();
+    }
+
+    // texture coordinates of image index inside the atlas
+    [[nodiscard]] TextureRect getRect(size_t index) const {
+        const Entry &entry = entries[index];
+        const auto width = static_cast<float>(slot->width);
+        const auto height = static_cast<float>(slot->height);
+        return TextureRect{static_cast<float>(entry.x) / width, static_cast<float>(entry.y) / height,
+                           static_cast<float>(entry.width) / width, static_cast<float>(entry.height) / height};
+    }
+
+    // the atlas is resident as soon as it's constructed, the handle never shows a placeholder
+    [[nodiscard]] TextureHandle getTexture() const {
+        return TextureHandle(slot, 0);
+    }
+
+    [[nodiscard]] const TextureAtlasStats &getStats() const {
+        return stats;
+    }
+};
+
+#endif //LEARNOPENGL_TEXTURE_ATLAS_H
@@ -0,0 +1,532 @@
+#ifndef LEARNOPENGL_TEXTURE_LOADER_H
+#define LEARNOPENGL_TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+#include "external/stb_image/stb_image.h"
+#include "resources/hash.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// GL side of a texture request, filled in by TextureLoader::update() once the image is on the GPU.
+// Owns the texture, so the last TextureHandle must be dropped on the GL thread.
+// A file with the same contents as one loaded earlier borrows that slot's texture.
+struct TextureSlot {
+    std::string path;
+    std::atomic<bool> ready{false};
+    std::atomic<bool> failed{false};
+    unsigned int texture = 0; // only valid once ready
+    int width = 0;
+    int height = 0;
+    size_t bytes = 0; // GPU memory including the mip chain, 0 for a borrowed texture
+    std::shared_ptr<TextureSlot> shared; // owner of texture when it's borrowed
+
+    TextureSlot() = default;
+    TextureSlot(const TextureSlot&) = delete;
+    TextureSlot& operator=(const TextureSlot&) = delete;
+    ~TextureSlot() {
+        if (texture != 0 && !shared) {
+            glDeleteTextures(1, &texture);
+        }
+    }
+};
+
+// Handle to a texture that may still be loading.
+// id() returns the loader's placeholder until the real texture is resident.
+class TextureHandle {
+private:
+    std::shared_ptr<TextureSlot> slot;
+    unsigned int placeholder = 0;
+public:
+    TextureHandle() = default;
+    TextureHandle(std::shared_ptr<TextureSlot> slot, unsigned int placeholder)
+        : slot(std::move(slot)), placeholder(placeholder) {}
+
+    [[nodiscard]] unsigned int id() const {
+        return ready() ? slot->texture : placeholder;
+    }
+    [[nodiscard]] bool ready() const {
+        return slot && slot->ready.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] bool failed() const {
+        return slot && slot->failed.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] const std::shared_ptr<TextureSlot> &getSlot() const {
+        return slot;
+    }
+};
+
+// Where an image sits inside its texture, in texture coordinates.
+// A quad's 0..1 coordinates become offset + coordinate * size in the vertex shader,
+// the default covers the whole texture, anything but an atlas needs no other.
+struct TextureRect {
+    float u = 0.0f;
+    float v = 0.0f;
+    float width = 1.0f;
+    float height = 1.0f;
+};
+
+struct TextureLoaderStats {
+    unsigned int requested = 0;
+    unsigned int uploaded = 0;
+    unsigned int failed = 0;
+    unsigned int stagedUploads = 0; // copied into a mapped PBO by a worker, transferred by the driver
+    unsigned int clientUploads = 0; // staging off, image too big or buffer not mapped, copied on the GL thread
+    unsigned int duplicates = 0;    // files with the same contents as an earlier one, sharing its texture
+    size_t uploadedBytes = 0;
+    double decodeMs = 0.0; // reading, hashing, decoding and copying into staging buffers, summed over all workers
+    double uploadMs = 0.0; // GL thread time spent in update()
+    double maxUpdateMs = 0.0; // the longest single update(), what a frame hitches by
+};
+
+// Decodes images with stb_image on worker threads and streams them into
+// GL textures through pixel buffer objects. The PBOs are mapped on the GL
+// thread ahead of time and the workers copy the decoded pixels straight into
+// them, so the GL thread only unmaps and issues the transfer. Mipmaps are
+// built a frame later, once a fence says the transfer has arrived.
+// Workers hash every file they read, a path whose contents were already
+// loaded under another path shares that texture instead of decoding again.
+class TextureLoader {
+private:
+    // a pixel buffer the workers can write into while it's mapped
+    struct StagingBuffer {
+        unsigned int PBO = 0;
+        unsigned char* mapped = nullptr; // set while it's in freeStaging
+        GLsync fence = nullptr;          // the transfer reading from it, it's remapped once that is done
+    };
+    // decoded image waiting for upload, always RGBA8. The pixels are in a
+    // staging buffer, or in stb_image's memory when staging is off or the image too big.
+    // A duplicate of an earlier file isn't decoded at all, it waits for source instead
+    struct DecodedImage {
+        std::shared_ptr<TextureSlot> slot;
+        std::shared_ptr<TextureSlot> source;
+        unsigned char* pixels = nullptr;
+        int staging = -1;
+        int width = 0;
+        int height = 0;
+    };
+    // level 0 is on its way to the GPU, the slot becomes ready after its mipmaps are built
+    struct PendingTexture {
+        std::shared_ptr<TextureSlot> slot;
+        unsigned int texture = 0;
+        GLsync fence = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+
+    static constexpr size_t STAGING_BUFFER_SIZE = 4 * 1024 * 1024; // a 1024x1024 RGBA8 image
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable stagingAvailable;
+    std::deque<std::shared_ptr<TextureSlot>> jobs;
+    std::deque<DecodedImage> decoded;
+    std::unordered_map<uint64_t, std::weak_ptr<TextureSlot>> slotsByContent; // file hash -> first slot, guarded by mutex
+    std::vector<int> freeStaging; // staging buffers no image is using, guarded by mutex
+    size_t pruneAt = 64; // slotsByContent size that triggers dropping released slots, guarded by mutex
+    bool stopping = false;
+    std::atomic<unsigned int> inFlight{0};
+
+    unsigned int placeholder = 0;
+    std::vector<StagingBuffer> staging; // never resized after construction, workers index into it
+    bool mapFailed = false; // reported once, it's retried on every use
+    std::vector<PendingTexture> pending;
+    std::vector<DecodedImage> duplicates; // waiting for their source to become ready
+    size_t uploadBudget; // bytes per update() call
+    TextureLoaderStats stats;
+    double decodeMsTotal = 0.0; // guarded by mutex
+
+    void workerLoop() {
+        for (;;) {
+            std::shared_ptr<TextureSlot> slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (stopping) {
+                    return;
+                }
+                slot = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            double ms = 0.0;
+            DecodedImage image;
+            image.slot = slot;
+            std::ifstream file(slot->path, std::ios::binary);
+            const std::string bytes{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+            if (!bytes.empty()) {
+                // different paths can still hold the same image, the first one to get here decodes it
+                const uint64_t key = hashString(bytes);
+                std::lock_guard<std::mutex> lock(mutex);
+                std::weak_ptr<TextureSlot> &first = slotsByContent[key];
+                image.source = first.lock();
+                if (!image.source) {
+                    first = slot;
+                }
+            }
+            int channels;
+            if (!image.source) {
+                // always expand to 4 channels so every row is 4-byte aligned for the upload
+                image.pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(bytes.data()),
+                                                     static_cast<int>(bytes.size()), &image.width, &image.height,
+                                                     &channels, 4);
+            }
+            if (image.pixels) {
+                const auto size = static_cast<size_t>(image.width) * static_cast<size_t>(image.height) * 4;
+                unsigned char* target = nullptr;
+                if (size <= STAGING_BUFFER_SIZE && !staging.empty()) {
+                    ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    // the GL thread hands buffers back once their transfer is done, waiting here keeps
+                    // the copy off the GL thread and stops decoding from running far ahead of uploads
+                    std::unique_lock<std::mutex> lock(mutex);
+                    stagingAvailable.wait(lock, [this] { return stopping || !freeStaging.empty(); });
+                    if (stopping) {
+                        stbi_image_free(image.pixels);
+                        return;
+                    }
+                    image.staging = freeStaging.back();
+                    freeStaging.pop_back();
+                    target = staging[static_cast<size_t>(image.staging)].mapped;
+                    start = std::chrono::steady_clock::now(); // the wait isn't decoding
+                }
+                if (target) {
+                    std::memcpy(target, image.pixels, size);
+                    stbi_image_free(image.pixels);
+                    image.pixels = nullptr;
+                }
+            }
+            ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            decodeMsTotal += ms;
+            decoded.push_back(image);
+        }
+    }
+
+    void createPlaceholder() {
+        // 2x2 magenta/black checker so missing textures are obvious
+        const unsigned char pixels[] = {
+            255, 0, 255, 255,   0, 0, 0, 255,
+            0, 0, 0, 255,       255, 0, 255, 255
+        };
+        glGenTextures(1, &placeholder);
+        glBindTexture(GL_TEXTURE_2D, placeholder);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+
+    // hands a staging buffer (back) to the workers, the driver may still be
+    // reading the previous contents so the old storage is invalidated. A buffer
+    // that fails to map goes back all the same: the worker that takes it keeps
+    // its pixels in client memory and upload() tries mapping it again
+    void mapStaging(int index) {
+        StagingBuffer &buffer = staging[static_cast<size_t>(index)];
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.PBO);
+        buffer.mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, STAGING_BUFFER_SIZE,
+                                                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!buffer.mapped && !mapFailed) {
+            std::cout << "Failed to map a texture staging buffer, uploading from client memory" << std::endl;
+            mapFailed = true;
+        }
+        returnStaging(index);
+    }
+
+    // a staging buffer a worker took but whose image is no longer wanted, as mapped as it was handed out
+    void returnStaging(int index) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeStaging.push_back(index);
+        }
+        stagingAvailable.notify_one();
+    }
+
+    // issue the transfer of level 0, from the staging buffer if the worker filled one
+    void upload(DecodedImage &image) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (image.pixels) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                         image.pixels);
+            stbi_image_free(image.pixels);
+            image.pixels = nullptr;
+            stats.clientUploads++;
+            if (image.staging >= 0) {
+                // the worker got a buffer that wasn't mapped
+                mapStaging(image.staging);
+            }
+        } else {
+            StagingBuffer &buffer = staging[static_cast<size_t>(image.staging)];
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.PBO);
+            buffer.mapped = nullptr;
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            } else {
+                // the mapped storage was lost (e.g. a mode switch), the texture keeps undefined contents
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+                std::cout << "Staging buffer lost while uploading " << image.slot->path << std::endl;
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            stats.stagedUploads++;
+        }
+        pending.push_back(PendingTexture{image.slot, texture, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+                                         image.width, image.height});
+    }
+
+    // level 0 has arrived: build the mipmaps from it and hand the texture out
+    void finish(const PendingTexture &texture) {
+        glBindTexture(GL_TEXTURE_2D, texture.texture);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        const auto size = static_cast<size_t>(texture.width) * static_cast<size_t>(texture.height) * 4;
+        texture.slot->texture = texture.texture;
+        texture.slot->width = texture.width;
+        texture.slot->height = texture.height;
+        texture.slot->bytes = size + size / 3; // a full mip chain adds about a third
+        texture.slot->ready.store(true, std::memory_order_release);
+        stats.uploaded++;
+        stats.uploadedBytes += size;
+    }
+
+    // true once the duplicate has its source's texture or failed along with it
+    bool share(const DecodedImage &image) {
+        const TextureSlot &source = *image.source;
+        if (source.failed.load(std::memory_order_acquire)) {
+            std::cout << "Failed to load texture " << image.slot->path << std::endl;
+            image.slot->failed.store(true, std::memory_order_release);
+            stats.failed++;
+            return true;
+        }
+        if (!source.ready.load(std::memory_order_acquire)) {
+            return false;
+        }
+        image.slot->shared = image.source;
+        image.slot->texture = source.texture;
+        image.slot->width = source.width;
+        image.slot->height = source.height;
+        image.slot->ready.store(true, std::memory_order_release);
+        stats.duplicates++;
+        return true;
+    }
+
+    static bool signaled(GLsync fence) {
+        // flush so the fence gets to the GPU even if nothing else is submitted
+        return glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0) != GL_TIMEOUT_EXPIRED;
+    }
+
+public:
+    // uploadBudget is the number of bytes update() may push to the GPU per call,
+    // stagingBuffers the number of PBOs workers copy into, 0 uploads everything from client memory
+    explicit TextureLoader(unsigned int workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1,
+                           size_t uploadBudget = 8 * 1024 * 1024, unsigned int stagingBuffers = 8)
+        : staging(stagingBuffers), uploadBudget(uploadBudget) {
+        createPlaceholder();
+        for (size_t i = 0; i < staging.size(); i++) {
+            glGenBuffers(1, &staging[i].PBO);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging[i].PBO);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, STAGING_BUFFER_SIZE, nullptr, GL_STREAM_DRAW);
+            mapStaging(static_cast<int>(i));
+        }
+        for (unsigned int i = 0; i < std::max(1u, workerCount); i++) {
+            workers.emplace_back(&TextureLoader::workerLoop, this);
+        }
+    }
+
+    ~TextureLoader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobAvailable.notify_all();
+        stagingAvailable.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        for (DecodedImage &image : decoded) {
+            stbi_image_free(image.pixels);
+        }
+        for (PendingTexture &texture : pending) {
+            glDeleteSync(texture.fence);
+            glDeleteTextures(1, &texture.texture);
+        }
+        for (StagingBuffer &buffer : staging) {
+            if (buffer.mapped) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.PBO);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            }
+            if (buffer.fence) {
+                glDeleteSync(buffer.fence);
+            }
+            glDeleteBuffers(1, &buffer.PBO);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteTextures(1, &placeholder);
+    }
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    // queue an image for loading, returns immediately
+    TextureHandle load(const std::string &path) {
+        auto slot = std::make_shared<TextureSlot>();
+        slot->path = path;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(slot);
+        }
+        jobAvailable.notify_one();
+        inFlight++;
+        stats.requested++;
+        return TextureHandle(slot, placeholder);
+    }
+
+    // call once per frame on the GL thread: finishes textures whose transfer has arrived,
+    // gives finished staging buffers back to the workers and starts the transfer of newly
+    // decoded images until the byte budget is used up
+    void update() {
+        const auto start = std::chrono::steady_clock::now();
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (!signaled(it->fence)) {
+                ++it;
+                continue;
+            }
+            glDeleteSync(it->fence);
+            if (it->slot.use_count() == 1) {
+                glDeleteTextures(1, &it->texture); // nobody wants it anymore
+            } else {
+                finish(*it);
+            }
+            inFlight--;
+            it = pending.erase(it);
+        }
+        for (auto it = duplicates.begin(); it != duplicates.end();) {
+            if (it->slot.use_count() == 1 || share(*it)) {
+                inFlight--;
+                it = duplicates.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (size_t i = 0; i < staging.size(); i++) {
+            if (staging[i].fence && signaled(staging[i].fence)) {
+                glDeleteSync(staging[i].fence);
+                staging[i].fence = nullptr;
+                mapStaging(static_cast<int>(i));
+            }
+        }
+
+        size_t uploadedThisFrame = 0;
+        // always upload at least one image so a single oversized texture can't stall forever
+        while (uploadedThisFrame == 0 || uploadedThisFrame < uploadBudget) {
+            DecodedImage image;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (decoded.empty()) {
+                    break;
+                }
+                image = decoded.front();
+                decoded.pop_front();
+            }
+            if (image.slot.use_count() == 1) {
+                // every handle was dropped while it was decoding, don't bother uploading
+                stbi_image_free(image.pixels);
+                if (image.staging >= 0) {
+                    returnStaging(image.staging);
+                }
+                inFlight--;
+                continue;
+            }
+            if (image.source) {
+                // nothing to upload, resolved once the source is ready
+                if (share(image)) {
+                    inFlight--;
+                } else {
+                    duplicates.push_back(image);
+                }
+                continue;
+            }
+            if (!image.pixels && image.staging < 0) {
+                std::cout << "Failed to load texture " << image.slot->path << std::endl;
+                image.slot->failed.store(true, std::memory_order_release);
+                stats.failed++;
+                inFlight--;
+                continue;
+            }
+            upload(image);
+            uploadedThisFrame += static_cast<size_t>(image.width) * static_cast<size_t>(image.height) * 4;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.decodeMs = decodeMsTotal;
+            if (slotsByContent.size() >= pruneAt) {
+                // forget files whose textures have all been released, amortized over the inserts
+                for (auto it = slotsByContent.begin(); it != slotsByContent.end();) {
+                    it = it->second.expired() ? slotsByContent.erase(it) : std::next(it);
+                }
+                pruneAt = std::max<size_t>(64, slotsByContent.size() * 2);
+            }
+        }
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.uploadMs += ms;
+        stats.maxUpdateMs = std::max(stats.maxUpdateMs, ms);
+    }
+
+    // true once every requested texture is either resident or failed
+    [[nodiscard]] bool idle() const {
+        return inFlight.load() == 0;
+    }
+
+    [[nodiscard]] unsigned int getPlaceholder() const {
+        return placeholder;
+    }
+
+    [[nodiscard]] const TextureLoaderStats &getStats() const {
+        return stats;
+    }
+};
+
+// the old blocking path: decode and upload on the calling (GL) thread
+inline unsigned int loadTextureSync(const char* path) {
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(path, &width, &height, &nrChannels, 4);
+    if (data) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    } else {
+        std::cout << "Failed to load texture " << path << std::endl;
+    }
+    stbi_image_free(data);
+    return texture;
+}
+
+#endif //LEARNOPENGL_TEXTURE_LOADER_H
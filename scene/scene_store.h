@@ -0,0 +1,443 @@
+#ifndef LEARNOPENGL_SCENE_STORE_H
+#define LEARNOPENGL_SCENE_STORE_H
+
+#include <glad/glad.h>
+#include "shaders.h"
+#include "structs/shapes.h"
+#include "renderer/batch_renderer.h"
+#include "resources/texture_loader.h"
+#include "scene/thread_pool.h"
+#include "scene/update_kernels.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Refers to an entity across swap-removes. The generation catches handles to
+// destroyed entities whose slot has since been reused.
+struct EntityHandle {
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;
+    uint32_t index = INVALID;
+    uint32_t generation = 0;
+
+    bool operator==(const EntityHandle &other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const EntityHandle &other) const {
+        return !(*this == other);
+    }
+};
+
+// everything needed to create an entity, material and texture come from addMaterial()/addTexture()
+struct EntityDesc {
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float velocity[2] = {0.0f, 0.0f}; // units per second
+    float scale = 1.0f;
+    float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    uint32_t material = 0;
+    uint32_t texture = 0;
+};
+
+// entities bounce off these edges
+struct SceneBounds {
+    float minX = -1.0f;
+    float maxX = 1.0f;
+    float minY = -1.0f;
+    float maxY = 1.0f;
+};
+
+// what an entity is drawn with, shared by every entity using the material id
+struct Material {
+    std::shared_ptr<Shader> shader;
+    std::shared_ptr<Mesh> mesh;
+};
+
+struct EntityColor {
+    float r, g, b, a;
+};
+
+// consecutive snapshot instances drawn with the same material + texture
+struct SnapshotRun {
+    uint32_t material;
+    uint32_t texture;
+    size_t first;
+    size_t count;
+};
+
+// Copy of the visible entities at one simulation tick, everything the render
+// thread needs to draw them without touching the SceneStore's arrays.
+struct SceneSnapshot {
+    uint64_t tick = 0;
+    double time = 0.0; // simulation time of this tick in seconds
+    std::vector<SnapshotRun> runs;
+    std::vector<QuadInstance> instances; // positions at this tick
+    std::vector<float> previousX;        // positions one tick earlier, same order as instances
+    std::vector<float> previousY;
+};
+
+// Structure-of-arrays store for the moving quads.
+// Every component lives in its own contiguous array and index i is the same
+// entity in all of them, so update() and submit() are straight loops over
+// memory. Destroying an entity moves the last one into its place; handles go
+// through a slot table so they stay valid while entities move around.
+class SceneStore {
+private:
+    struct Slot {
+        uint32_t dense = 0;      // index into the component arrays while alive
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    // components, all the same length
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> scales;
+    std::vector<EntityColor> colors;
+    std::vector<uint32_t> materialIds;
+    std::vector<uint32_t> textureIds;
+    std::vector<uint32_t> owners; // dense index -> slot index
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+
+    std::vector<Material> materials;
+    std::vector<TextureHandle> textures;
+    std::vector<TextureRect> textureRects; // same index as textures
+
+    // submit() scratch, kept to avoid reallocating every frame
+    std::vector<size_t> groupCounts;
+    std::vector<QuadInstance*> groupCursors;
+
+    // positions before the current tick, see savePositions()
+    std::vector<float> previousX;
+    std::vector<float> previousY;
+
+    // updateAndCull() output and scratch
+    std::vector<uint32_t> visible;
+    std::vector<uint32_t> cullScratch;
+    std::vector<size_t> chunkVisible;
+    std::vector<size_t> chunkOffsets;
+
+    [[nodiscard]] const Slot* find(EntityHandle handle) const {
+        if (handle.index >= slots.size()) {
+            return nullptr;
+        }
+        const Slot &slot = slots[handle.index];
+        return slot.alive && slot.generation == handle.generation ? &slot : nullptr;
+    }
+
+    // indices == nullptr submits the first count entities
+    void submitEntities(BatchRenderer &batch, const uint32_t* indices, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        const size_t textureCount = textures.size();
+        groupCounts.assign(materials.size() * textureCount, 0);
+        for (size_t n = 0; n < count; n++) {
+            const size_t i = indices ? indices[n] : n;
+            groupCounts[materialIds[i] * textureCount + textureIds[i]]++;
+        }
+        groupCursors.assign(groupCounts.size(), nullptr);
+        for (size_t group = 0; group < groupCounts.size(); group++) {
+            if (groupCounts[group] == 0) {
+                continue;
+            }
+            const Material &material = materials[group / textureCount];
+            groupCursors[group] = batch.allocate(material.shader->getId(), textures[group % textureCount].id(),
+                                                 material.mesh->VAO, material.mesh->indexCount, material.mesh->indexType,
+                                                 groupCounts[group]);
+        }
+        for (size_t n = 0; n < count; n++) {
+            const size_t i = indices ? indices[n] : n;
+            QuadInstance* out = groupCursors[materialIds[i] * textureCount + textureIds[i]]++;
+            out->offset[0] = positionX[i];
+            out->offset[1] = positionY[i];
+            out->offset[2] = positionZ[i];
+            out->scale = scales[i];
+            out->color[0] = colors[i].r;
+            out->color[1] = colors[i].g;
+            out->color[2] = colors[i].b;
+            out->color[3] = colors[i].a;
+            std::memcpy(out->texRect, &textureRects[textureIds[i]], sizeof(out->texRect));
+        }
+    }
+
+public:
+    SceneStore() = default;
+
+    SceneStore(const SceneStore&) = delete;
+    SceneStore& operator=(const SceneStore&) = delete;
+
+    uint32_t addMaterial(std::shared_ptr<Shader> shader, std::shared_ptr<Mesh> mesh) {
+        materials.push_back(Material{std::move(shader), std::move(mesh)});
+        return static_cast<uint32_t>(materials.size() - 1);
+    }
+
+    // rect picks one image out of an atlas, several texture ids can share the same atlas
+    uint32_t addTexture(TextureHandle texture, const TextureRect &rect = TextureRect{}) {
+        textures.push_back(std::move(texture));
+        textureRects.push_back(rect);
+        return static_cast<uint32_t>(textures.size() - 1);
+    }
+
+    void reserve(size_t count) {
+        positionX.reserve(count);
+        positionY.reserve(count);
+        positionZ.reserve(count);
+        velocityX.reserve(count);
+        velocityY.reserve(count);
+        scales.reserve(count);
+        colors.reserve(count);
+        materialIds.reserve(count);
+        textureIds.reserve(count);
+        owners.reserve(count);
+        slots.reserve(count);
+    }
+
+    EntityHandle create(const EntityDesc &desc) {
+        uint32_t slotIndex;
+        if (freeSlots.empty()) {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.emplace_back();
+        } else {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        Slot &slot = slots[slotIndex];
+        slot.dense = static_cast<uint32_t>(positionX.size());
+        slot.alive = true;
+
+        positionX.push_back(desc.position[0]);
+        positionY.push_back(desc.position[1]);
+        positionZ.push_back(desc.position[2]);
+        velocityX.push_back(desc.velocity[0]);
+        velocityY.push_back(desc.velocity[1]);
+        scales.push_back(desc.scale);
+        colors.push_back(EntityColor{desc.color[0], desc.color[1], desc.color[2], desc.color[3]});
+        materialIds.push_back(desc.material);
+        textureIds.push_back(desc.texture);
+        owners.push_back(slotIndex);
+        return EntityHandle{slotIndex, slot.generation};
+    }
+
+    // swap-remove: the last entity takes the destroyed one's place, returns false for stale handles
+    bool destroy(EntityHandle handle) {
+        const Slot* found = find(handle);
+        if (found == nullptr) {
+            return false;
+        }
+        const uint32_t dense = found->dense;
+        const auto last = static_cast<uint32_t>(positionX.size() - 1);
+        if (dense != last) {
+            positionX[dense] = positionX[last];
+            positionY[dense] = positionY[last];
+            positionZ[dense] = positionZ[last];
+            velocityX[dense] = velocityX[last];
+            velocityY[dense] = velocityY[last];
+            scales[dense] = scales[last];
+            colors[dense] = colors[last];
+            materialIds[dense] = materialIds[last];
+            textureIds[dense] = textureIds[last];
+            owners[dense] = owners[last];
+            slots[owners[dense]].dense = dense;
+        }
+        positionX.pop_back();
+        positionY.pop_back();
+        positionZ.pop_back();
+        velocityX.pop_back();
+        velocityY.pop_back();
+        scales.pop_back();
+        colors.pop_back();
+        materialIds.pop_back();
+        textureIds.pop_back();
+        owners.pop_back();
+        // keep the saved positions lined up with the entities
+        if (previousX.size() > last) {
+            previousX[dense] = previousX[last];
+            previousY[dense] = previousY[last];
+            previousX.resize(last);
+            previousY.resize(last);
+        }
+
+        Slot &slot = slots[handle.index];
+        slot.alive = false;
+        slot.generation++;
+        freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    [[nodiscard]] bool isAlive(EntityHandle handle) const {
+        return find(handle) != nullptr;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return positionX.size();
+    }
+
+    // these return false for stale handles
+    bool setPosition(EntityHandle handle, float x, float y, float z) {
+        const Slot* slot = find(handle);
+        if (slot == nullptr) {
+            return false;
+        }
+        positionX[slot->dense] = x;
+        positionY[slot->dense] = y;
+        positionZ[slot->dense] = z;
+        return true;
+    }
+    bool setVelocity(EntityHandle handle, float x, float y) {
+        const Slot* slot = find(handle);
+        if (slot == nullptr) {
+            return false;
+        }
+        velocityX[slot->dense] = x;
+        velocityY[slot->dense] = y;
+        return true;
+    }
+    bool getPosition(EntityHandle handle, float &x, float &y, float &z) const {
+        const Slot* slot = find(handle);
+        if (slot == nullptr) {
+            return false;
+        }
+        x = positionX[slot->dense];
+        y = positionY[slot->dense];
+        z = positionZ[slot->dense];
+        return true;
+    }
+
+    // moves every entity by its velocity and reflects it off the bounds
+    void update(float deltaTime, const SceneBounds &bounds) {
+        const size_t count = positionX.size();
+        float* px = positionX.data();
+        float* py = positionY.data();
+        float* vx = velocityX.data();
+        float* vy = velocityY.data();
+        for (size_t i = 0; i < count; i++) {
+            float x = px[i] + vx[i] * deltaTime;
+            float y = py[i] + vy[i] * deltaTime;
+            if (x > bounds.maxX || x < bounds.minX) {
+                x = x > bounds.maxX ? 2.0f * bounds.maxX - x : 2.0f * bounds.minX - x;
+                vx[i] = -vx[i];
+            }
+            if (y > bounds.maxY || y < bounds.minY) {
+                y = y > bounds.maxY ? 2.0f * bounds.maxY - y : 2.0f * bounds.minY - y;
+                vy[i] = -vy[i];
+            }
+            px[i] = x;
+            py[i] = y;
+        }
+    }
+
+    // Moves every entity like update() and collects the ones overlapping view into
+    // getVisible(), in index order. Chunks of entities are spread over the pool's
+    // threads, each runs the SIMD kernel and writes its visible entities to its own
+    // part of a scratch list, which is then compacted.
+    void updateAndCull(float deltaTime, const SceneBounds &bounds, const SceneBounds &view, ThreadPool &pool,
+                       SimdLevel level = detectSimdLevel(), size_t chunkSize = 16384) {
+        const size_t count = positionX.size();
+        const UpdateArrays arrays{positionX.data(), positionY.data(), velocityX.data(), velocityY.data(), scales.data()};
+        const UpdateParams params{deltaTime, bounds.minX, bounds.maxX, bounds.minY, bounds.maxY,
+                                  view.minX, view.maxX, view.minY, view.maxY};
+        const size_t chunks = ThreadPool::chunkCount(count, chunkSize);
+        cullScratch.resize(count);
+        chunkVisible.assign(chunks, 0);
+        pool.parallelFor(count, chunkSize, [&](size_t chunk, size_t begin, size_t end) {
+            chunkVisible[chunk] = updateCull(level, arrays, params, begin, end, cullScratch.data() + begin);
+        });
+
+        chunkOffsets.resize(chunks);
+        size_t total = 0;
+        for (size_t chunk = 0; chunk < chunks; chunk++) {
+            chunkOffsets[chunk] = total;
+            total += chunkVisible[chunk];
+        }
+        visible.resize(total);
+        pool.parallelFor(chunks, 16, [&](size_t, size_t begin, size_t end) {
+            for (size_t chunk = begin; chunk < end; chunk++) {
+                std::memcpy(visible.data() + chunkOffsets[chunk], cullScratch.data() + chunk * chunkSize,
+                            chunkVisible[chunk] * sizeof(uint32_t));
+            }
+        });
+    }
+
+    // indices of the entities that passed the last updateAndCull()
+    [[nodiscard]] const std::vector<uint32_t> &getVisible() const {
+        return visible;
+    }
+
+    // remembers the current positions as the previous tick's, call before updating
+    void savePositions() {
+        previousX = positionX;
+        previousY = positionY;
+    }
+
+    // copies the entities from the last updateAndCull() into out, grouped into runs by material + texture
+    void writeSnapshot(SceneSnapshot &out) {
+        const size_t count = visible.size();
+        const size_t textureCount = textures.size();
+        out.runs.clear();
+        out.instances.resize(count);
+        out.previousX.resize(count);
+        out.previousY.resize(count);
+        if (count == 0) {
+            return;
+        }
+        groupCounts.assign(materials.size() * textureCount, 0);
+        for (const uint32_t i : visible) {
+            groupCounts[materialIds[i] * textureCount + textureIds[i]]++;
+        }
+        // groupCounts becomes each group's write position
+        size_t first = 0;
+        for (size_t group = 0; group < groupCounts.size(); group++) {
+            const size_t groupCount = groupCounts[group];
+            if (groupCount == 0) {
+                continue;
+            }
+            out.runs.push_back(SnapshotRun{static_cast<uint32_t>(group / textureCount),
+                                           static_cast<uint32_t>(group % textureCount), first, groupCount});
+            groupCounts[group] = first;
+            first += groupCount;
+        }
+        for (const uint32_t i : visible) {
+            const size_t n = groupCounts[materialIds[i] * textureCount + textureIds[i]]++;
+            QuadInstance &instance = out.instances[n];
+            instance.offset[0] = positionX[i];
+            instance.offset[1] = positionY[i];
+            instance.offset[2] = positionZ[i];
+            instance.scale = scales[i];
+            instance.color[0] = colors[i].r;
+            instance.color[1] = colors[i].g;
+            instance.color[2] = colors[i].b;
+            instance.color[3] = colors[i].a;
+            std::memcpy(instance.texRect, &textureRects[textureIds[i]], sizeof(instance.texRect));
+            // entities created since savePositions() have no previous position
+            const bool hasPrevious = i < previousX.size();
+            out.previousX[n] = hasPrevious ? previousX[i] : positionX[i];
+            out.previousY[n] = hasPrevious ? previousY[i] : positionY[i];
+        }
+    }
+
+    // materials and textures must not be added while another thread reads them
+    [[nodiscard]] const Material &getMaterial(uint32_t id) const {
+        return materials[id];
+    }
+    [[nodiscard]] const TextureHandle &getTexture(uint32_t id) const {
+        return textures[id];
+    }
+
+    // writes every entity straight into the batch's instance arrays, one allocation per material + texture pair
+    void submit(BatchRenderer &batch) {
+        submitEntities(batch, nullptr, positionX.size());
+    }
+
+    // like submit() but only the entities from the last updateAndCull()
+    void submitVisible(BatchRenderer &batch) {
+        submitEntities(batch, visible.data(), visible.size());
+    }
+};
+
+#endif //LEARNOPENGL_SCENE_STORE_H
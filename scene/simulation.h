@@ -0,0 +1,238 @@
+#ifndef LEARNOPENGL_SIMULATION_H
+#define LEARNOPENGL_SIMULATION_H
+
+#include "scene/scene_store.h"
+#include "scene/thread_pool.h"
+#include "scene/triple_buffer.h"
+#include "renderer/batch_renderer.h"
+#include "profiling/profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+struct SimulationStats {
+    uint64_t ticks = 0;
+    uint64_t skippedTicks = 0;     // ticks dropped after the simulation fell too far behind
+    uint64_t staleFrames = 0;      // frames rendered past the newest snapshot, motion froze for them
+    ProfilePercentiles tickMs;     // time spent simulating one tick
+    ProfilePercentiles jitterMs;   // how late ticks started compared to the fixed schedule
+    ProfilePercentiles latencyMs;  // wall time minus the simulation time a frame showed
+};
+
+inline std::ostream &operator<<(std::ostream &out, const SimulationStats &stats) {
+    out << "simulation: " << stats.ticks << " ticks (" << stats.skippedTicks << " skipped), tick p50 "
+        << stats.tickMs.p50 << " ms / p99 " << stats.tickMs.p99 << " ms, jitter p50 " << stats.jitterMs.p50
+        << " ms / p99 " << stats.jitterMs.p99 << " ms, render latency p50 " << stats.latencyMs.p50 << " ms / p99 "
+        << stats.latencyMs.p99 << " ms, " << stats.staleFrames << " stale frames";
+    return out;
+}
+
+// Runs SceneStore updates on their own thread at a fixed tick rate.
+// Every tick publishes a SceneSnapshot through a lock-free triple buffer. The
+// render thread draws the newest one interpolated between its previous and
+// current positions, one tick behind real time, so motion is smooth at any
+// frame rate and a slow frame never delays the simulation (or the other way round).
+// Without start() the simulation only advances through step(), in lockstep with
+// the caller, which keeps headless captures reproducible.
+class SimulationThread {
+private:
+    static constexpr int MAX_TICKS_BEHIND = 5;
+    static constexpr size_t HISTORY = 600;
+
+    SceneStore &scene;
+    SceneBounds bounds;
+    SceneBounds view;
+    double tickSeconds;
+    ThreadPool pool;
+    TripleBuffer<SceneSnapshot> snapshots;
+    bool hasSnapshot = false;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<double> loadMs{0.0};
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    uint64_t tick = 0;
+
+    // written by both threads, read by getStats()
+    mutable std::mutex statsMutex;
+    std::vector<double> tickTimes;
+    std::vector<double> jitters;
+    std::vector<double> latencies;
+    uint64_t ticks = 0;
+    uint64_t frames = 0;
+    uint64_t skippedTicks = 0;
+    uint64_t staleFrames = 0;
+
+    static void record(std::vector<double> &history, uint64_t index, double value) {
+        if (history.size() < HISTORY) {
+            history.push_back(value);
+        } else {
+            history[index % HISTORY] = value;
+        }
+    }
+
+    static void spin(double ms) {
+        const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+
+    // simulates one tick and publishes it as taking place at time seconds
+    void runTick(double time) {
+        const auto start = std::chrono::steady_clock::now();
+        scene.savePositions();
+        scene.updateAndCull(static_cast<float>(tickSeconds), bounds, view, pool);
+        spin(loadMs.load(std::memory_order_relaxed));
+        SceneSnapshot &snapshot = snapshots.writeBuffer();
+        scene.writeSnapshot(snapshot);
+        snapshot.tick = ++tick;
+        snapshot.time = time;
+        snapshots.publish();
+
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(statsMutex);
+        record(tickTimes, ticks, ms);
+        ticks++;
+    }
+
+    void loop() {
+        uint64_t scheduled = tick;
+        while (running.load(std::memory_order_relaxed)) {
+            scheduled++;
+            const double scheduledTime = static_cast<double>(scheduled) * tickSeconds;
+            std::this_thread::sleep_until(epoch + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(scheduledTime)));
+            const double late = now() - scheduledTime;
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                record(jitters, ticks, late * 1000.0);
+            }
+            runTick(scheduledTime);
+            // too far behind to catch up, drop the missed ticks instead of running them back to back
+            const auto behind = static_cast<uint64_t>((now() - scheduledTime) / tickSeconds);
+            if (behind > MAX_TICKS_BEHIND) {
+                scheduled += behind;
+                std::lock_guard<std::mutex> lock(statsMutex);
+                skippedTicks += behind;
+            }
+        }
+    }
+
+public:
+    // tickRate is in ticks per second, threads is passed on to the update ThreadPool
+    SimulationThread(SceneStore &scene, const SceneBounds &bounds, const SceneBounds &view, double tickRate = 60.0,
+                     unsigned int threads = std::max(1u, std::thread::hardware_concurrency()))
+        : scene(scene), bounds(bounds), view(view), tickSeconds(1.0 / tickRate), pool(threads) {}
+
+    ~SimulationThread() {
+        stop();
+    }
+
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // the SceneStore belongs to the simulation thread until stop()
+    void start() {
+        if (running.exchange(true)) {
+            return;
+        }
+        // line the clock up so the next tick is due one tick from now, not counting the time before start()
+        epoch = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(static_cast<double>(tick) * tickSeconds));
+        thread = std::thread(&SimulationThread::loop, this);
+    }
+
+    void stop() {
+        running.store(false);
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    // lockstep alternative to start(): simulates one tick on the calling thread
+    void step() {
+        runTick(static_cast<double>(tick + 1) * tickSeconds);
+    }
+
+    // busy work added to every tick, for testing how the render side copes with a slow simulation
+    void setArtificialLoad(double ms) {
+        loadMs.store(ms, std::memory_order_relaxed);
+    }
+
+    // seconds on the simulation's clock, tick n is scheduled at n * tick length
+    [[nodiscard]] double now() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    [[nodiscard]] double getTickSeconds() const {
+        return tickSeconds;
+    }
+
+    [[nodiscard]] unsigned int getThreadCount() const {
+        return pool.getThreadCount();
+    }
+
+    // render side: picks up the newest snapshot, false until the first one was published
+    bool acquire() {
+        hasSnapshot |= snapshots.update();
+        return hasSnapshot;
+    }
+
+    // render side: the snapshot taken by the last acquire()
+    [[nodiscard]] const SceneSnapshot &latest() const {
+        return snapshots.readBuffer();
+    }
+
+    // render side: how far to blend from the snapshot's previous to its current positions.
+    // Frames show the simulation one tick in the past, so there is always a tick to blend
+    // towards. In lockstep the newest tick is shown as is.
+    float interpolation(const SceneSnapshot &snapshot) {
+        if (!running.load(std::memory_order_relaxed)) {
+            return 1.0f;
+        }
+        const double wallTime = now();
+        const double alpha = (wallTime - snapshot.time) / tickSeconds;
+        const double shown = snapshot.time - tickSeconds + std::min(alpha, 1.0) * tickSeconds;
+        std::lock_guard<std::mutex> lock(statsMutex);
+        record(latencies, frames++, (wallTime - shown) * 1000.0);
+        if (alpha > 1.0) {
+            staleFrames++;
+        }
+        return static_cast<float>(std::clamp(alpha, 0.0, 1.0));
+    }
+
+    [[nodiscard]] SimulationStats getStats() const {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        SimulationStats stats;
+        stats.ticks = ticks;
+        stats.skippedTicks = skippedTicks;
+        stats.staleFrames = staleFrames;
+        stats.tickMs = Profiler::percentiles(tickTimes);
+        stats.jitterMs = Profiler::percentiles(jitters);
+        stats.latencyMs = Profiler::percentiles(latencies);
+        return stats;
+    }
+};
+
+// writes a snapshot into the batch with every position blended by alpha from the previous tick to the current one
+inline void submitInterpolated(BatchRenderer &batch, const SceneStore &scene, const SceneSnapshot &snapshot, float alpha) {
+    for (const SnapshotRun &run : snapshot.runs) {
+        const Material &material = scene.getMaterial(run.material);
+        QuadInstance* out = batch.allocate(material.shader->getId(), scene.getTexture(run.texture).id(),
+                                           material.mesh->VAO, material.mesh->indexCount, material.mesh->indexType,
+                                           run.count);
+        for (size_t n = run.first; n < run.first + run.count; n++) {
+            *out = snapshot.instances[n];
+            out->offset[0] = snapshot.previousX[n] + (out->offset[0] - snapshot.previousX[n]) * alpha;
+            out->offset[1] = snapshot.previousY[n] + (out->offset[1] - snapshot.previousY[n]) * alpha;
+            out++;
+        }
+    }
+}
+
+#endif //LEARNOPENGL_SIMULATION_H
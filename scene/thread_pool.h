@@ -0,0 +1,123 @@
+#ifndef LEARNOPENGL_THREAD_POOL_H
+#define LEARNOPENGL_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data parallel loops.
+// parallelFor() splits a range into chunks that the workers and the calling
+// thread pull from a shared counter, and returns once every chunk is done.
+// Only one parallelFor() may run at a time.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    bool stopping = false;
+    uint64_t generation = 0;   // bumped for every parallelFor()
+    unsigned int busy = 0;     // workers still inside the current job
+
+    // the current job
+    const std::function<void(size_t, size_t, size_t)>* job = nullptr;
+    size_t jobCount = 0;
+    size_t chunkSize = 1;
+    size_t chunkTotal = 0;
+    std::atomic<size_t> nextChunk{0};
+
+    void runChunks() {
+        for (size_t chunk = nextChunk.fetch_add(1); chunk < chunkTotal; chunk = nextChunk.fetch_add(1)) {
+            const size_t begin = chunk * chunkSize;
+            (*job)(chunk, begin, std::min(begin + chunkSize, jobCount));
+        }
+    }
+
+    void workerLoop() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+            }
+            runChunks();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                busy--;
+            }
+            done.notify_one();
+        }
+    }
+
+public:
+    // threads counts the calling thread too, so 1 means no workers at all
+    explicit ThreadPool(unsigned int threads = std::max(1u, std::thread::hardware_concurrency())) {
+        for (unsigned int i = 1; i < std::max(1u, threads); i++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] unsigned int getThreadCount() const {
+        return static_cast<unsigned int>(workers.size()) + 1;
+    }
+
+    // how many chunks parallelFor() will split count items into
+    [[nodiscard]] static size_t chunkCount(size_t count, size_t size) {
+        return (count + size - 1) / size;
+    }
+
+    // calls fn(chunkIndex, begin, end) for every chunk of at most size items
+    void parallelFor(size_t count, size_t size, const std::function<void(size_t, size_t, size_t)> &fn) {
+        if (count == 0) {
+            return;
+        }
+        size = std::max<size_t>(1, size);
+        if (workers.empty() || count <= size) {
+            for (size_t chunk = 0, begin = 0; begin < count; chunk++, begin += size) {
+                fn(chunk, begin, std::min(begin + size, count));
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobCount = count;
+            chunkSize = size;
+            chunkTotal = chunkCount(count, size);
+            nextChunk.store(0);
+            busy = static_cast<unsigned int>(workers.size());
+            generation++;
+        }
+        wake.notify_all();
+        runChunks();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+        job = nullptr;
+    }
+};
+
+#endif //LEARNOPENGL_THREAD_POOL_H
@@ -0,0 +1,54 @@
+#ifndef LEARNOPENGL_TRIPLE_BUFFER_H
+#define LEARNOPENGL_TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free hand-off of the latest value from one writer thread to one reader thread.
+// The writer fills writeBuffer() and publish()es it, the reader calls update() and
+// then reads readBuffer(). Neither side ever waits: the third buffer sits between
+// them and is swapped atomically, so the reader always sees a complete value and
+// values the reader never picked up are simply overwritten.
+template<typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4; // the middle buffer holds a value the reader hasn't taken yet
+
+    T buffers[3];
+    std::atomic<uint8_t> middle{1};
+    uint8_t back = 0;  // owned by the writer
+    uint8_t front = 2; // owned by the reader
+
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // writer side: the buffer to fill, it may hold an old value worth reusing the memory of
+    T &writeBuffer() {
+        return buffers[back];
+    }
+
+    // writer side: hands the filled buffer over and takes the middle one to write next
+    void publish() {
+        back = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // reader side: swaps in the newest published value, false if nothing new arrived
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // reader side: the value taken by the last successful update()
+    const T &readBuffer() const {
+        return buffers[front];
+    }
+};
+
+#endif //LEARNOPENGL_TRIPLE_BUFFER_H
@@ -0,0 +1,228 @@
+#ifndef LEARNOPENGL_UPDATE_KERNELS_H
+#define LEARNOPENGL_UPDATE_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LEARNOPENGL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX instructions in functions marked for it, MSVC always can
+#if defined(LEARNOPENGL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define LEARNOPENGL_TARGET_AVX __attribute__((target("avx")))
+#else
+#define LEARNOPENGL_TARGET_AVX
+#endif
+
+// Integrate + bounce + cull kernels over a range of SceneStore's component arrays.
+// All versions do exactly the same float operations in the same order (no FMA),
+// so they produce bit identical positions and the same visible list.
+
+enum class SimdLevel {
+    Scalar,
+    SSE,
+    AVX
+};
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX: return "AVX";
+        case SimdLevel::SSE: return "SSE";
+        default: return "scalar";
+    }
+}
+
+// the widest kernel this CPU runs, SSE2 is part of x86-64 so it's always there
+inline SimdLevel detectSimdLevel() {
+#if defined(LEARNOPENGL_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    // the OS also has to save the upper halves of the YMM registers
+    if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+        return SimdLevel::AVX;
+    }
+#else
+    if (__builtin_cpu_supports("avx")) {
+        return SimdLevel::AVX;
+    }
+#endif
+    return SimdLevel::SSE;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// component arrays of the entities one kernel call works on
+struct UpdateArrays {
+    float* positionX;
+    float* positionY;
+    float* velocityX;
+    float* velocityY;
+    const float* scale;
+};
+
+// entities bounce inside bounds and are visible if their quad overlaps view
+struct UpdateParams {
+    float deltaTime;
+    float minX, maxX, minY, maxY; // bounds
+    float viewMinX, viewMaxX, viewMinY, viewMaxY;
+};
+
+// each kernel updates [begin, end) and writes the indices of the visible entities
+// to visible, returning how many it wrote (at most end - begin)
+
+inline size_t updateCullScalar(const UpdateArrays &a, const UpdateParams &p, size_t begin, size_t end, uint32_t* visible) {
+    size_t written = 0;
+    for (size_t i = begin; i < end; i++) {
+        float x = a.positionX[i] + a.velocityX[i] * p.deltaTime;
+        float y = a.positionY[i] + a.velocityY[i] * p.deltaTime;
+        if (x > p.maxX || x < p.minX) {
+            x = x > p.maxX ? 2.0f * p.maxX - x : 2.0f * p.minX - x;
+            a.velocityX[i] = -a.velocityX[i];
+        }
+        if (y > p.maxY || y < p.minY) {
+            y = y > p.maxY ? 2.0f * p.maxY - y : 2.0f * p.minY - y;
+            a.velocityY[i] = -a.velocityY[i];
+        }
+        a.positionX[i] = x;
+        a.positionY[i] = y;
+
+        const float half = a.scale[i] * 0.5f;
+        const bool inside = x + half >= p.viewMinX && x - half <= p.viewMaxX &&
+                            y + half >= p.viewMinY && y - half <= p.viewMaxY;
+        visible[written] = static_cast<uint32_t>(i);
+        written += inside ? 1 : 0;
+    }
+    return written;
+}
+
+#if defined(LEARNOPENGL_X86)
+
+// index of the lowest set bit, mask must not be 0
+inline unsigned int lowestSetBit(unsigned int mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned int>(index);
+#else
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+}
+
+inline size_t updateCullSSE(const UpdateArrays &a, const UpdateParams &p, size_t begin, size_t end, uint32_t* visible) {
+    const __m128 dt = _mm_set1_ps(p.deltaTime);
+    const __m128 minX = _mm_set1_ps(p.minX), maxX = _mm_set1_ps(p.maxX);
+    const __m128 minY = _mm_set1_ps(p.minY), maxY = _mm_set1_ps(p.maxY);
+    const __m128 twoMinX = _mm_set1_ps(2.0f * p.minX), twoMaxX = _mm_set1_ps(2.0f * p.maxX);
+    const __m128 twoMinY = _mm_set1_ps(2.0f * p.minY), twoMaxY = _mm_set1_ps(2.0f * p.maxY);
+    const __m128 viewMinX = _mm_set1_ps(p.viewMinX), viewMaxX = _mm_set1_ps(p.viewMaxX);
+    const __m128 viewMinY = _mm_set1_ps(p.viewMinY), viewMaxY = _mm_set1_ps(p.viewMaxY);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    // SSE2 has no blendv, select with and/andnot/or
+    auto select = [](__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    };
+
+    size_t written = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(a.velocityX + i);
+        __m128 vy = _mm_loadu_ps(a.velocityY + i);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(a.positionX + i), _mm_mul_ps(vx, dt));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(a.positionY + i), _mm_mul_ps(vy, dt));
+
+        const __m128 overX = _mm_cmpgt_ps(x, maxX), underX = _mm_cmplt_ps(x, minX);
+        x = select(overX, _mm_sub_ps(twoMaxX, x), select(underX, _mm_sub_ps(twoMinX, x), x));
+        vx = _mm_xor_ps(vx, _mm_and_ps(_mm_or_ps(overX, underX), sign));
+        const __m128 overY = _mm_cmpgt_ps(y, maxY), underY = _mm_cmplt_ps(y, minY);
+        y = select(overY, _mm_sub_ps(twoMaxY, y), select(underY, _mm_sub_ps(twoMinY, y), y));
+        vy = _mm_xor_ps(vy, _mm_and_ps(_mm_or_ps(overY, underY), sign));
+
+        _mm_storeu_ps(a.positionX + i, x);
+        _mm_storeu_ps(a.positionY + i, y);
+        _mm_storeu_ps(a.velocityX + i, vx);
+        _mm_storeu_ps(a.velocityY + i, vy);
+
+        const __m128 h = _mm_mul_ps(_mm_loadu_ps(a.scale + i), half);
+        __m128 inside = _mm_cmpge_ps(_mm_add_ps(x, h), viewMinX);
+        inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_sub_ps(x, h), viewMaxX));
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(y, h), viewMinY));
+        inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_sub_ps(y, h), viewMaxY));
+        for (unsigned int mask = static_cast<unsigned int>(_mm_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+            visible[written++] = static_cast<uint32_t>(i + lowestSetBit(mask));
+        }
+    }
+    return written + updateCullScalar(a, p, i, end, visible + written);
+}
+
+LEARNOPENGL_TARGET_AVX
+inline size_t updateCullAVX(const UpdateArrays &a, const UpdateParams &p, size_t begin, size_t end, uint32_t* visible) {
+    const __m256 dt = _mm256_set1_ps(p.deltaTime);
+    const __m256 minX = _mm256_set1_ps(p.minX), maxX = _mm256_set1_ps(p.maxX);
+    const __m256 minY = _mm256_set1_ps(p.minY), maxY = _mm256_set1_ps(p.maxY);
+    const __m256 twoMinX = _mm256_set1_ps(2.0f * p.minX), twoMaxX = _mm256_set1_ps(2.0f * p.maxX);
+    const __m256 twoMinY = _mm256_set1_ps(2.0f * p.minY), twoMaxY = _mm256_set1_ps(2.0f * p.maxY);
+    const __m256 viewMinX = _mm256_set1_ps(p.viewMinX), viewMaxX = _mm256_set1_ps(p.viewMaxX);
+    const __m256 viewMinY = _mm256_set1_ps(p.viewMinY), viewMaxY = _mm256_set1_ps(p.viewMaxY);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    size_t written = 0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(a.velocityX + i);
+        __m256 vy = _mm256_loadu_ps(a.velocityY + i);
+        __m256 x = _mm256_add_ps(_mm256_loadu_ps(a.positionX + i), _mm256_mul_ps(vx, dt));
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(a.positionY + i), _mm256_mul_ps(vy, dt));
+
+        const __m256 overX = _mm256_cmp_ps(x, maxX, _CMP_GT_OQ), underX = _mm256_cmp_ps(x, minX, _CMP_LT_OQ);
+        x = _mm256_blendv_ps(_mm256_blendv_ps(x, _mm256_sub_ps(twoMinX, x), underX), _mm256_sub_ps(twoMaxX, x), overX);
+        vx = _mm256_xor_ps(vx, _mm256_and_ps(_mm256_or_ps(overX, underX), sign));
+        const __m256 overY = _mm256_cmp_ps(y, maxY, _CMP_GT_OQ), underY = _mm256_cmp_ps(y, minY, _CMP_LT_OQ);
+        y = _mm256_blendv_ps(_mm256_blendv_ps(y, _mm256_sub_ps(twoMinY, y), underY), _mm256_sub_ps(twoMaxY, y), overY);
+        vy = _mm256_xor_ps(vy, _mm256_and_ps(_mm256_or_ps(overY, underY), sign));
+
+        _mm256_storeu_ps(a.positionX + i, x);
+        _mm256_storeu_ps(a.positionY + i, y);
+        _mm256_storeu_ps(a.velocityX + i, vx);
+        _mm256_storeu_ps(a.velocityY + i, vy);
+
+        const __m256 h = _mm256_mul_ps(_mm256_loadu_ps(a.scale + i), half);
+        __m256 inside = _mm256_cmp_ps(_mm256_add_ps(x, h), viewMinX, _CMP_GE_OQ);
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_sub_ps(x, h), viewMaxX, _CMP_LE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(y, h), viewMinY, _CMP_GE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_sub_ps(y, h), viewMaxY, _CMP_LE_OQ));
+        for (unsigned int mask = static_cast<unsigned int>(_mm256_movemask_ps(inside)); mask != 0; mask &= mask - 1) {
+            visible[written++] = static_cast<uint32_t>(i + lowestSetBit(mask));
+        }
+    }
+    // avoid the AVX -> SSE transition penalty in the scalar tail
+    _mm256_zeroupper();
+    return written + updateCullScalar(a, p, i, end, visible + written);
+}
+
+#endif
+
+inline size_t updateCull(SimdLevel level, const UpdateArrays &a, const UpdateParams &p, size_t begin, size_t end,
+                         uint32_t* visible) {
+#if defined(LEARNOPENGL_X86)
+    if (level == SimdLevel::AVX) {
+        return updateCullAVX(a, p, begin, end, visible);
+    }
+    if (level == SimdLevel::SSE) {
+        return updateCullSSE(a, p, begin, end, visible);
+    }
+#endif
+    return updateCullScalar(a, p, begin, end, visible);
+}
+
+#endif //LEARNOPENGL_UPDATE_KERNELS_H
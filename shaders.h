@@ -6,87 +6,271 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 class Shader {
 private:
+    // last value uploaded to a uniform location, lets setters skip redundant glUniform calls
+    struct UniformShadow {
+        bool valid = false;
+        float data[16] = {};
+    };
+    // an active uniform as the driver reports it, arrays cover size consecutive locations
+    struct ActiveUniform {
+        std::string name;
+        int location;
+        int size;
+        GLenum type;
+    };
+    // shared between copies of a Shader so they all agree on what the program holds
+    struct UniformState {
+        std::unordered_map<std::string, int> locations;
+        std::vector<ActiveUniform> active;
+        std::vector<UniformShadow> shadows; // indexed by location
+        unsigned int uploads = 0;
+        unsigned int skipped = 0;
+    };
+
     // the program ID
-    unsigned int ID;
+    unsigned int ID = 0;
+    bool linked = false;
+    std::shared_ptr<UniformState> uniforms = std::make_shared<UniformState>();
+
+    // query every active uniform once after linking so lookups never hit the driver
+    void reflectUniforms() {
+        int count = 0;
+        int maxNameLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+        std::vector<char> nameBuffer(static_cast<size_t>(maxNameLength) + 1);
+        int maxLocation = -1;
+        for (int i = 0; i < count; i++) {
+            int size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), nullptr, &size, &type,
+                               nameBuffer.data());
+            std::string name(nameBuffer.data());
+            const int location = glGetUniformLocation(ID, name.c_str());
+            if (location < 0) {
+                continue; // uniform block members have no location
+            }
+            // arrays are reported as "name[0]", make them reachable as "name" too
+            const size_t bracket = name.find('[');
+            if (bracket != std::string::npos) {
+                uniforms->locations[name.substr(0, bracket)] = location;
+            }
+            uniforms->locations[name] = location;
+            uniforms->active.push_back(ActiveUniform{name, location, size, type});
+            // every array element gets its own consecutive location
+            maxLocation = std::max(maxLocation, location + size - 1);
+        }
+        uniforms->shadows.assign(static_cast<size_t>(maxLocation + 1), UniformShadow{});
+    }
+
+    // returns false if the value matches what was last uploaded to this location
+    bool shouldUpload(int location, const float* values, size_t count) const {
+        if (location < 0) {
+            return false;
+        }
+        auto &shadows = uniforms->shadows;
+        if (static_cast<size_t>(location) >= shadows.size()) {
+            shadows.resize(static_cast<size_t>(location) + 1);
+        }
+        UniformShadow &shadow = shadows[static_cast<size_t>(location)];
+        if (shadow.valid && std::memcmp(shadow.data, values, count * sizeof(float)) == 0) {
+            uniforms->skipped++;
+            return false;
+        }
+        std::memcpy(shadow.data, values, count * sizeof(float));
+        shadow.valid = true;
+        uniforms->uploads++;
+        return true;
+    }
+
+    // issues a shadowed value to the program in use, false for types no setter produces
+    static bool uploadShadow(int location, GLenum type, const float* data) {
+        switch (type) {
+            case GL_FLOAT: glUniform1fv(location, 1, data); return true;
+            case GL_FLOAT_VEC2: glUniform2fv(location, 1, data); return true;
+            case GL_FLOAT_VEC3: glUniform3fv(location, 1, data); return true;
+            case GL_FLOAT_VEC4: glUniform4fv(location, 1, data); return true;
+            case GL_FLOAT_MAT4: glUniformMatrix4fv(location, 1, GL_FALSE, data); return true;
+            case GL_INT:
+            case GL_BOOL:
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_3D:
+            case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_2D_ARRAY: {
+                int value;
+                std::memcpy(&value, data, sizeof(value));
+                glUniform1i(location, value);
+                return true;
+            }
+            default: return false;
+        }
+    }
+
+    // copies every value set on the previous program into the new one where a uniform
+    // of the same name and type survived the edit, the new program must be in use
+    void restoreUniforms(const UniformState &previous) {
+        std::unordered_map<std::string, const ActiveUniform*> byName;
+        for (const ActiveUniform &uniform : previous.active) {
+            byName[uniform.name] = &uniform;
+        }
+        for (const ActiveUniform &uniform : uniforms->active) {
+            const auto it = byName.find(uniform.name);
+            if (it == byName.end() || it->second->type != uniform.type) {
+                continue;
+            }
+            const int elements = std::min(uniform.size, it->second->size);
+            for (int element = 0; element < elements; element++) {
+                const auto from = static_cast<size_t>(it->second->location + element);
+                const auto to = static_cast<size_t>(uniform.location + element);
+                if (from >= previous.shadows.size() || !previous.shadows[from].valid || to >= uniforms->shadows.size()) {
+                    continue;
+                }
+                if (uploadShadow(uniform.location + element, uniform.type, previous.shadows[from].data)) {
+                    uniforms->shadows[to] = previous.shadows[from];
+                    uniforms->uploads++;
+                }
+            }
+        }
+    }
+
+    Shader() = default;
+
+    // compiles both stages and links them into ID, a stage that fails to compile leaves ID at 0
+    // retrievable asks the driver to keep the binary around for glGetProgramBinary
+    void build(const std::string &vertexCode, const std::string &fragmentCode, bool retrievable = false) {
+        const unsigned int vertex = compileStage(GL_VERTEX_SHADER, vertexCode);
+        const unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, fragmentCode);
+        // check both so every error gets printed, but don't link a program that can't work
+        const bool vertexCompiled = checkCompiled(vertex, "VERTEX");
+        const bool fragmentCompiled = checkCompiled(fragment, "FRAGMENT");
+        if (vertexCompiled && fragmentCompiled) {
+            const unsigned int program = linkProgram(vertex, fragment, retrievable);
+            if (checkLinked(program)) {
+                ID = program;
+                linked = true;
+                reflectUniforms();
+            } else {
+                glDeleteProgram(program);
+            }
+        }
+
+        // delete the shaders as they're linked into our program now and no longer necessary
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+    }
 public:
     // constructor reads and builds the shader
     Shader(const char* vertexPath, const char* fragmentPath) {
         // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
+        const std::string vertexCode = readFile(vertexPath);
+        const std::string fragmentCode = readFile(fragmentPath);
+        // 2. compile and link them
+        build(vertexCode, fragmentCode);
+    }
+
+    // builds the shader from source code that is already in memory
+    static Shader fromSource(const std::string &vertexCode, const std::string &fragmentCode, bool retrievable = false) {
+        Shader shader;
+        shader.build(vertexCode, fragmentCode, retrievable);
+        return shader;
+    }
+
+    // takes over an already linked program, e.g. one restored with glProgramBinary
+    static Shader fromProgram(unsigned int program) {
+        Shader shader;
+        shader.ID = program;
+        shader.linked = true;
+        shader.reflectUniforms();
+        return shader;
+    }
+
+    // creates a shader object and starts compiling it, check the result with checkCompiled()
+    // with GL_KHR_parallel_shader_compile the driver may still be compiling when this returns
+    static unsigned int compileStage(GLenum type, const std::string &code) {
+        const char* source = code.c_str();
+        const unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        return shader;
+    }
+
+    // creates a program from both stages and starts linking it, check the result with checkLinked()
+    static unsigned int linkProgram(unsigned int vertex, unsigned int fragment, bool retrievable = false) {
+        const unsigned int program = glCreateProgram();
+        glAttachShader(program, vertex);
+        glAttachShader(program, fragment);
+        if (retrievable) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         }
-        catch (std::ifstream::failure &e) {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
-        }
-        const char *vShaderCode = vertexCode.c_str();
-        const char *fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
-        unsigned int vertex, fragment;
-        int success;
-        char infoLog[512];
-
-        // vertex Shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, nullptr);
-        glCompileShader(vertex);
-        // print compile errors if any
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-        if(!success)
-        {
-            glGetShaderInfoLog(vertex, 512, nullptr, infoLog);
-            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-        };
-
-        // similiar for Fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, nullptr);
-        glCompileShader(fragment);
-        // print compile errors if present
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-        if(!success)
-        {
-            glGetShaderInfoLog(vertex, 512, nullptr, infoLog);
-            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-        };
-
-        // shader Program
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        // print linking errors if any
-        glGetProgramiv(ID, GL_LINK_STATUS, &success);
-        if(!success)
-        {
-            glGetProgramInfoLog(ID, 512, nullptr, infoLog);
+        glLinkProgram(program);
+        return program;
+    }
+
+    // waits for the compile, prints the stage's log if it failed
+    static bool checkCompiled(unsigned int shader, const char* stage) {
+        int success = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+            std::cout << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return success != 0;
+    }
+
+    // waits for the link, prints the program's log if it failed
+    static bool checkLinked(unsigned int program) {
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetProgramInfoLog(program, sizeof(infoLog), nullptr, infoLog);
             std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
         }
+        return success != 0;
+    }
 
-        // delete the shaders as they're linked into our program now and no longer necessary
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
+    // swaps in another linked program, e.g. a reloaded one, and returns the old one for the caller to delete.
+    // Uniform locations are reflected again and the values set on the old program are uploaded to the
+    // new one, so uniforms that are only set once at startup survive the swap
+    unsigned int replaceProgram(unsigned int program) {
+        const unsigned int old = ID;
+        const std::shared_ptr<UniformState> previous = uniforms;
+        ID = program;
+        linked = true;
+        uniforms = std::make_shared<UniformState>();
+        reflectUniforms();
+        int current = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &current);
+        glUseProgram(ID);
+        restoreUniforms(*previous);
+        // the caller's program stays bound, unless it was the one being replaced
+        glUseProgram(static_cast<unsigned int>(current) == old ? ID : static_cast<unsigned int>(current));
+        return old;
+    }
+
+    // reads a whole shader file, returns an empty string if it can't be read
+    static std::string readFile(const char* path) {
+        std::ifstream file;
+        file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        try {
+            file.open(path);
+            std::stringstream stream;
+            stream << file.rdbuf();
+            return stream.str();
+        }
+        catch (std::ifstream::failure &e) {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ " << path << std::endl;
+            return {};
+        }
     }
 
 
@@ -94,15 +278,81 @@ public:
     void use() const {
         glUseProgram(ID);
     }
-    // utility uniform functions
+    // cached location of an active uniform, -1 if the program doesn't use it
+    [[nodiscard]] int getUniformLocation(const std::string &name) const {
+        const auto it = uniforms->locations.find(name);
+        return it == uniforms->locations.end() ? -1 : it->second;
+    }
+    // utility uniform functions, the program must be in use
+    // values are compared against a CPU-side copy and only uploaded when they change
     void setBool(const std::string &name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        setInt(getUniformLocation(name), (int)value);
     }
     void setInt(const std::string &name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        setInt(getUniformLocation(name), value);
     }
     void setFloat(const std::string &name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        setFloat(getUniformLocation(name), value);
+    }
+    void setVec2(const std::string &name, float x, float y) const {
+        setVec2(getUniformLocation(name), x, y);
+    }
+    void setVec3(const std::string &name, float x, float y, float z) const {
+        setVec3(getUniformLocation(name), x, y, z);
+    }
+    void setVec4(const std::string &name, float x, float y, float z, float w) const {
+        setVec4(getUniformLocation(name), x, y, z, w);
+    }
+    void setMat4(const std::string &name, const float* value) const {
+        setMat4(getUniformLocation(name), value);
+    }
+    // location based overloads for hot paths, look the location up once with getUniformLocation
+    void setInt(int location, int value) const {
+        // ints are shadowed bit-for-bit in the float storage
+        float bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        if (shouldUpload(location, &bits, 1)) {
+            glUniform1i(location, value);
+        }
+    }
+    void setFloat(int location, float value) const {
+        if (shouldUpload(location, &value, 1)) {
+            glUniform1f(location, value);
+        }
+    }
+    void setVec2(int location, float x, float y) const {
+        const float value[2] = {x, y};
+        if (shouldUpload(location, value, 2)) {
+            glUniform2fv(location, 1, value);
+        }
+    }
+    void setVec3(int location, float x, float y, float z) const {
+        const float value[3] = {x, y, z};
+        if (shouldUpload(location, value, 3)) {
+            glUniform3fv(location, 1, value);
+        }
+    }
+    void setVec4(int location, float x, float y, float z, float w) const {
+        const float value[4] = {x, y, z, w};
+        if (shouldUpload(location, value, 4)) {
+            glUniform4fv(location, 1, value);
+        }
+    }
+    // column-major 4x4 matrix
+    void setMat4(int location, const float* value) const {
+        if (shouldUpload(location, value, 16)) {
+            glUniformMatrix4fv(location, 1, GL_FALSE, value);
+        }
+    }
+    // how many uniform uploads went to the driver vs. were skipped as redundant
+    [[nodiscard]] unsigned int getUniformUploads() const {
+        return uniforms->uploads;
+    }
+    [[nodiscard]] unsigned int getSkippedUniformUploads() const {
+        return uniforms->skipped;
+    }
+    [[nodiscard]] bool isLinked() const {
+        return linked;
     }
     [[nodiscard]] unsigned int getId() const {
         return ID;
@@ -3,10 +3,11 @@ out vec4 FragColor;
 
 in vec3 ourColor;
 in vec2 TexCoord;
+in vec4 instanceColor;
 
 uniform sampler2D ourTexture;
 
 void main()
 {
-    FragColor = texture(ourTexture, TexCoord);
+    FragColor = texture(ourTexture, TexCoord) * instanceColor;
 }
\ No newline at end of file
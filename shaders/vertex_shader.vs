@@ -2,14 +2,18 @@
 layout (location = 0) in vec3 aPos;   // the position variable has attribute position 0
 layout (location = 1) in vec3 aColor; // the color variable has attribute position 1
 layout (location = 2) in vec2 aTexCoord; // the texture variable has attribute position 2
+layout (location = 3) in vec4 aInstanceOffset; // per-instance offset (xyz) and scale (w)
+layout (location = 4) in vec4 aInstanceColor; // per-instance tint
+layout (location = 5) in vec4 aInstanceTexRect; // per-instance image rect inside the texture (xy offset, zw size)
 
 out vec3 ourColor; // output a color to the fragment shader
 out vec2 TexCoord;
-uniform vec3 posOffset;
+out vec4 instanceColor;
 
 void main()
 {
-    gl_Position = vec4(aPos + posOffset, 1.0);
+    gl_Position = vec4(aPos * aInstanceOffset.w + aInstanceOffset.xyz, 1.0);
     ourColor = aColor; // set ourColor to the input color we got from the vertex data
-    TexCoord = aTexCoord;
+    TexCoord = aInstanceTexRect.xy + aTexCoord * aInstanceTexRect.zw;
+    instanceColor = aInstanceColor;
 }
\ No newline at end of file
@@ -5,16 +5,30 @@
 #ifndef LEARNOPENGL_SHAPES_H
 #define LEARNOPENGL_SHAPES_H
 
+#include <glad/glad.h>
+#include <cstddef>
+
 struct TriangleVertexArray {
     float vertices[9];
 };
 
-struct Triangle {
-    Shader shaderProgram;
-    unsigned int VAO;
-    unsigned int texture;
-    unsigned int VBO;
-    unsigned int EBO;
+// GPU buffers for a piece of indexed geometry, deleted along with the Mesh
+struct Mesh {
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+    unsigned int indexCount = 0;
+    unsigned int indexType = GL_UNSIGNED_INT; // or GL_UNSIGNED_SHORT for meshes loaded from files
+    size_t bytes = 0; // vertex + index data size
+
+    Mesh() = default;
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    ~Mesh() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+    }
 };
 
 #endif //LEARNOPENGL_SHAPES_H
\ No newline at end of file
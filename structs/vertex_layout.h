@@ -0,0 +1,134 @@
+#ifndef LEARNOPENGL_VERTEX_LAYOUT_H
+#define LEARNOPENGL_VERTEX_LAYOUT_H
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// one vertex shader input inside an interleaved vertex
+struct VertexAttribute {
+    unsigned int location = 0;
+    int components = 0;
+    GLenum type = GL_FLOAT;
+    bool normalized = false; // integer types are mapped to 0..1 (unsigned) or -1..1 (signed)
+    unsigned int offset = 0; // bytes from the start of the vertex
+};
+
+[[nodiscard]] inline unsigned int vertexTypeSize(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT: return 2;
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT: return 4;
+        default: return 0;
+    }
+}
+
+// one vertex in VertexLayout::quantized()
+struct QuantizedVertex {
+    float position[3];
+    uint8_t color[4];
+    uint16_t texCoord[2]; // half floats, see floatToHalf()
+};
+static_assert(sizeof(QuantizedVertex) == 20, "QuantizedVertex must match VertexLayout::quantized()");
+
+// Describes how interleaved vertices are laid out, so the VAO setup can be
+// derived from the data instead of being written out by hand for every mesh.
+struct VertexLayout {
+    static constexpr size_t MAX_ATTRIBUTES = 8;
+    // GL_MAX_VERTEX_ATTRIBS is at least this on every GL 3.3 implementation
+    static constexpr unsigned int MAX_LOCATIONS = 16;
+    // locations 3, 4 and 5 carry BatchRenderer's per-instance data, a mesh's own attributes can't use them
+    static constexpr unsigned int FIRST_INSTANCE_LOCATION = 3;
+    static constexpr unsigned int INSTANCE_LOCATIONS = 3;
+
+    // true if a per-vertex attribute may use location
+    [[nodiscard]] static bool isVertexLocation(unsigned int location) {
+        return location < MAX_LOCATIONS &&
+               (location < FIRST_INSTANCE_LOCATION || location >= FIRST_INSTANCE_LOCATION + INSTANCE_LOCATIONS);
+    }
+
+    unsigned int stride = 0;
+    std::vector<VertexAttribute> attributes;
+
+    // points the attributes of the currently bound VAO at the bound GL_ARRAY_BUFFER
+    void apply() const {
+        for (const VertexAttribute &attribute : attributes) {
+            glVertexAttribPointer(attribute.location, attribute.components, attribute.type,
+                                  attribute.normalized ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(stride),
+                                  reinterpret_cast<void*>(static_cast<uintptr_t>(attribute.offset)));
+            glEnableVertexAttribArray(attribute.location);
+        }
+    }
+
+    // the quad vertices in main(): position, color and texture coordinates as 8 floats
+    static VertexLayout positionColorTexCoord() {
+        VertexLayout layout;
+        layout.stride = 8 * sizeof(float);
+        layout.attributes = {
+            {0, 3, GL_FLOAT, false, 0},
+            {1, 3, GL_FLOAT, false, 3 * sizeof(float)},
+            {2, 2, GL_FLOAT, false, 6 * sizeof(float)}
+        };
+        return layout;
+    }
+
+    // the same inputs in 20 bytes instead of 32: float position, RGBA8 color and half float texture coordinates
+    static VertexLayout quantized() {
+        VertexLayout layout;
+        layout.stride = sizeof(QuantizedVertex);
+        layout.attributes = {
+            {0, 3, GL_FLOAT, false, offsetof(QuantizedVertex, position)},
+            {1, 4, GL_UNSIGNED_BYTE, true, offsetof(QuantizedVertex, color)},
+            {2, 2, GL_HALF_FLOAT, false, offsetof(QuantizedVertex, texCoord)}
+        };
+        return layout;
+    }
+};
+
+// IEEE half precision, rounded to nearest even, for quantizing texture coordinates
+[[nodiscard]] inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    static_assert(sizeof(bits) == sizeof(value), "float must be 32 bits");
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+    const uint32_t magnitude = bits & 0x7FFFFFFFu;
+    if (magnitude >= 0x7F800000u) {
+        // infinity stays infinity, NaN stays a (quiet) NaN
+        return static_cast<uint16_t>(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+    }
+    if (magnitude >= 0x477FF000u) {
+        return static_cast<uint16_t>(sign | 0x7C00u); // too large, rounds to infinity
+    }
+    if (magnitude < 0x38800000u) {
+        // subnormal half, or zero below half the smallest subnormal
+        if (magnitude < 0x33000000u) {
+            return sign;
+        }
+        const uint32_t exponent = magnitude >> 23;
+        const uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+        const uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1u))) {
+            half++;
+        }
+        return static_cast<uint16_t>(sign | half);
+    }
+    // normal half: rebias the exponent and round the mantissa from 23 to 10 bits
+    uint32_t half = (magnitude - 0x38000000u) >> 13;
+    const uint32_t remainder = magnitude & 0x1FFFu;
+    if (remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) {
+        half++;
+    }
+    return static_cast<uint16_t>(sign | half);
+}
+
+#endif //LEARNOPENGL_VERTEX_LAYOUT_H
@@ -0,0 +1,258 @@
+// Converts Wavefront OBJ files into the binary .lmesh format read by MeshFile.
+// usage: obj_converter input.obj output.lmesh [--fit]
+// Every "o"/"g" group becomes its own mesh. Vertices are written in
+// VertexLayout::quantized(): float positions, RGBA8 colors (from the "v x y z r g b"
+// extension, white otherwise) and half float texture coordinates. Polygons are
+// triangulated as fans, normals are ignored since no shader uses them yet.
+// --fit scales and centers everything into [-0.5, 0.5], the size of the quad in main().
+#include <glad/glad.h>
+#include "structs/vertex_layout.h"
+#include "resources/mesh_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ObjPosition {
+    float xyz[3];
+    float rgb[3];
+};
+
+struct ObjData {
+    std::vector<ObjPosition> positions;
+    std::vector<float> texCoords; // 2 per entry
+    std::vector<MeshData> meshes;
+    // per mesh: (position, texcoord) pair -> vertex index, so shared corners stay shared
+    std::unordered_map<uint64_t, uint32_t> vertexLookup;
+};
+
+// OBJ indices start at 1, negative ones count back from the newest element
+bool resolveIndex(long value, size_t count, size_t &out) {
+    if (value > 0 && static_cast<size_t>(value) <= count) {
+        out = static_cast<size_t>(value - 1);
+        return true;
+    }
+    if (value < 0 && static_cast<size_t>(-value) <= count) {
+        out = count - static_cast<size_t>(-value);
+        return true;
+    }
+    return false;
+}
+
+MeshData &currentMesh(ObjData &obj, const std::string &name) {
+    if (obj.meshes.empty() || (!name.empty() && !obj.meshes.back().indices.empty())) {
+        obj.meshes.emplace_back();
+        obj.meshes.back().layout = VertexLayout::quantized();
+        obj.vertexLookup.clear();
+    }
+    if (!name.empty()) {
+        obj.meshes.back().name = name;
+    }
+    return obj.meshes.back();
+}
+
+// index of the vertex for a "v/vt/vn" corner, adding it on first use
+bool addCorner(ObjData &obj, const char* corner, uint32_t &out) {
+    char* end = nullptr;
+    size_t position = 0;
+    if (!resolveIndex(std::strtol(corner, &end, 10), obj.positions.size(), position)) {
+        return false;
+    }
+    size_t texCoord = SIZE_MAX;
+    if (*end == '/' && end[1] != '/') {
+        size_t resolved = 0;
+        if (resolveIndex(std::strtol(end + 1, nullptr, 10), obj.texCoords.size() / 2, resolved)) {
+            texCoord = resolved;
+        }
+    }
+
+    MeshData &mesh = currentMesh(obj, "");
+    const uint64_t key = (static_cast<uint64_t>(position) << 32) | (texCoord & 0xFFFFFFFFu);
+    const auto found = obj.vertexLookup.find(key);
+    if (found != obj.vertexLookup.end()) {
+        out = found->second;
+        return true;
+    }
+
+    const ObjPosition &source = obj.positions[position];
+    QuantizedVertex vertex{};
+    for (int c = 0; c < 3; c++) {
+        vertex.position[c] = source.xyz[c];
+        vertex.color[c] = static_cast<uint8_t>(std::lround(std::clamp(source.rgb[c], 0.0f, 1.0f) * 255.0f));
+    }
+    vertex.color[3] = 255;
+    const float u = texCoord == SIZE_MAX ? 0.0f : obj.texCoords[texCoord * 2];
+    const float v = texCoord == SIZE_MAX ? 0.0f : obj.texCoords[texCoord * 2 + 1];
+    vertex.texCoord[0] = floatToHalf(u);
+    vertex.texCoord[1] = floatToHalf(v);
+
+    out = static_cast<uint32_t>(mesh.vertices.size() / sizeof(QuantizedVertex));
+    const auto* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+    mesh.vertices.insert(mesh.vertices.end(), bytes, bytes + sizeof(vertex));
+    obj.vertexLookup.emplace(key, out);
+    return true;
+}
+
+bool parseObj(const std::string &path, ObjData &obj) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cout << "Failed to open " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    std::vector<uint32_t> polygon;
+    size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        const char* cursor = line.c_str();
+        while (*cursor == ' ' || *cursor == '\t') {
+            cursor++;
+        }
+        char* end = nullptr;
+        if (cursor[0] == 'v' && cursor[1] == ' ') {
+            ObjPosition position{{0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+            cursor += 2;
+            for (float &value : position.xyz) {
+                value = std::strtof(cursor, &end);
+                cursor = end;
+            }
+            // optional vertex colors
+            const float r = std::strtof(cursor, &end);
+            if (end != cursor) {
+                position.rgb[0] = r;
+                cursor = end;
+                position.rgb[1] = std::strtof(cursor, &end);
+                cursor = end;
+                position.rgb[2] = std::strtof(cursor, &end);
+            }
+            obj.positions.push_back(position);
+        } else if (cursor[0] == 'v' && cursor[1] == 't') {
+            cursor += 2;
+            const float u = std::strtof(cursor, &end);
+            cursor = end;
+            const float v = std::strtof(cursor, &end);
+            obj.texCoords.push_back(u);
+            obj.texCoords.push_back(v);
+        } else if ((cursor[0] == 'o' || cursor[0] == 'g') && cursor[1] == ' ') {
+            std::string name = cursor + 2;
+            while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) {
+                name.pop_back();
+            }
+            currentMesh(obj, name.empty() ? "mesh" : name);
+        } else if (cursor[0] == 'f' && cursor[1] == ' ') {
+            polygon.clear();
+            cursor += 2;
+            while (*cursor != '\0' && *cursor != '\r') {
+                if (*cursor == ' ' || *cursor == '\t') {
+                    cursor++;
+                    continue;
+                }
+                uint32_t vertex = 0;
+                if (!addCorner(obj, cursor, vertex)) {
+                    std::cout << path << ":" << lineNumber << ": bad face index" << std::endl;
+                    return false;
+                }
+                polygon.push_back(vertex);
+                while (*cursor != '\0' && *cursor != ' ' && *cursor != '\t' && *cursor != '\r') {
+                    cursor++;
+                }
+            }
+            MeshData &mesh = currentMesh(obj, "");
+            for (size_t i = 2; i < polygon.size(); i++) {
+                mesh.indices.insert(mesh.indices.end(), {polygon[0], polygon[i - 1], polygon[i]});
+            }
+        }
+    }
+    // groups without faces have nothing to draw
+    obj.meshes.erase(std::remove_if(obj.meshes.begin(), obj.meshes.end(),
+                                    [](const MeshData &mesh) { return mesh.indices.empty(); }),
+                     obj.meshes.end());
+    return true;
+}
+
+void computeBounds(MeshData &mesh) {
+    const size_t count = mesh.vertices.size() / sizeof(QuantizedVertex);
+    auto* vertices = reinterpret_cast<QuantizedVertex*>(mesh.vertices.data());
+    for (int c = 0; c < 3; c++) {
+        mesh.boundsMin[c] = count > 0 ? vertices[0].position[c] : 0.0f;
+        mesh.boundsMax[c] = mesh.boundsMin[c];
+    }
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < 3; c++) {
+            mesh.boundsMin[c] = std::min(mesh.boundsMin[c], vertices[i].position[c]);
+            mesh.boundsMax[c] = std::max(mesh.boundsMax[c], vertices[i].position[c]);
+        }
+    }
+}
+
+// one uniform scale for all meshes so they keep their relative size and placement
+void fitToUnitQuad(std::vector<MeshData> &meshes) {
+    float low[3] = {INFINITY, INFINITY, INFINITY};
+    float high[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (const MeshData &mesh : meshes) {
+        for (int c = 0; c < 3; c++) {
+            low[c] = std::min(low[c], mesh.boundsMin[c]);
+            high[c] = std::max(high[c], mesh.boundsMax[c]);
+        }
+    }
+    const float extent = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2], 1e-6f});
+    const float scale = 1.0f / extent;
+    for (MeshData &mesh : meshes) {
+        auto* vertices = reinterpret_cast<QuantizedVertex*>(mesh.vertices.data());
+        for (size_t i = 0; i < mesh.vertices.size() / sizeof(QuantizedVertex); i++) {
+            for (int c = 0; c < 3; c++) {
+                vertices[i].position[c] = (vertices[i].position[c] - (low[c] + high[c]) * 0.5f) * scale;
+            }
+        }
+        computeBounds(mesh);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "usage: obj_converter input.obj output.lmesh [--fit]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const bool fit = argc > 3 && std::strcmp(argv[3], "--fit") == 0;
+    const auto start = std::chrono::steady_clock::now();
+
+    ObjData obj;
+    if (!parseObj(argv[1], obj) || obj.meshes.empty()) {
+        std::cout << "No faces found in " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t vertices = 0;
+    size_t triangles = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < obj.meshes.size(); i++) {
+        MeshData &mesh = obj.meshes[i];
+        if (mesh.name.empty()) {
+            mesh.name = "mesh" + std::to_string(i);
+        }
+        computeBounds(mesh);
+        const size_t count = mesh.vertices.size() / sizeof(QuantizedVertex);
+        vertices += count;
+        triangles += mesh.indices.size() / 3;
+        bytes += count * 8 * sizeof(float) + mesh.indices.size() * sizeof(uint32_t);
+    }
+    if (fit) {
+        fitToUnitQuad(obj.meshes);
+    }
+    if (!writeMeshFile(argv[2], obj.meshes)) {
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream written(argv[2], std::ios::binary | std::ios::ate);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << argv[2] << ": " << obj.meshes.size() << " meshes, " << vertices << " vertices, " << triangles
+              << " triangles, " << written.tellg() << " B (" << bytes << " B as 8 floats per vertex and 32 bit indices), "
+              << ms << " ms" << std::endl;
+    return EXIT_SUCCESS;
+}